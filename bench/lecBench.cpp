@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <benchmark/benchmark.h>
+#include "bruteForceOracle.h"
+#include "geojsonReader.h"
+#include "largestEmptyCircle.h"
+#include "pointGenerators.h"
+
+// microbenchmarks of every stage of the largest empty circle, each one over n points of a few distributions, run with
+// --benchmark_format=json (or --benchmark_out=FILE --benchmark_out_format=json) to compare two builds
+
+namespace {
+
+// side of the square where the points are generated
+const double kSide = 1000;
+
+// function that returns n points of the distribution, always the same ones for the same n
+std::vector<Point_2> makePoints(std::size_t n, PointDistribution distribution) {
+    PointGeneratorOptions options;
+    options.distribution = distribution;
+    options.seed = n;
+    options.xmax = options.ymax = kSide;
+    std::vector<double> coordinates = generatePoints(n, options);
+    std::vector<Point_2> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; i++) points.push_back(Point_2(coordinates[2 * i], coordinates[2 * i + 1]));
+    return points;
+}
+
+// the input of every stage for some points, built once and shared by the benchmarks with the same arguments
+struct Workload {
+    std::vector<Point_2> points;
+    LargestEmptyCircleStages stages;
+    // a geojson file with the points as sites, for the ingest
+    std::string sitesFilename;
+
+    ~Workload() {
+        if (!sitesFilename.empty()) std::remove(sitesFilename.c_str());
+    }
+};
+
+// function that returns the workload of the arguments of the benchmark (n and the distribution)
+Workload& getWorkload(const benchmark::State& state) {
+    static std::map<std::pair<std::int64_t, std::int64_t>, std::unique_ptr<Workload>> workloads;
+    std::unique_ptr<Workload>& workload = workloads[std::make_pair(state.range(0), state.range(1))];
+    if (!workload) {
+        workload.reset(new Workload());
+        workload->points = makePoints(static_cast<std::size_t>(state.range(0)), getPointDistributions()[state.range(1)]);
+        runLargestEmptyCircleStages(workload->points, workload->stages);
+    }
+    return *workload;
+}
+
+// function that sets the label and the processed items of a benchmark
+void finishBenchmark(benchmark::State& state, std::size_t items) {
+    state.SetLabel(getPointDistributionName(getPointDistributions()[state.range(1)]));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * items));
+}
+
+// reading the sites from a geojson file
+void BM_Ingest(benchmark::State& state) {
+    Workload& workload = getWorkload(state);
+    if (workload.sitesFilename.empty()) {
+        workload.sitesFilename = "/tmp/lec_bench_" + std::to_string(state.range(0)) + "_" + std::to_string(state.range(1)) + ".geojson";
+        std::ofstream file(workload.sitesFilename);
+        file.precision(17);
+        file << "{\"type\": \"FeatureCollection\", \"features\": [\n";
+        for (std::size_t i = 0; i < workload.points.size(); i++) {
+            file << (i > 0 ? ",\n" : "") << "{\"type\": \"Feature\", \"properties\": {\"@id\": \"node/" << i << "\"}, \"geometry\": {\"type\": \"Point\", \"coordinates\": [" << CGAL::to_double(workload.points[i].x()) << ", " << CGAL::to_double(workload.points[i].y()) << "]}}";
+        }
+        file << "\n]}\n";
+    }
+    for (auto _ : state) {
+        std::vector<Point_2> points;
+        readSitePoints(workload.sitesFilename, points);
+        benchmark::DoNotOptimize(points.data());
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// inserting the points in the Delaunay triangulation
+void BM_Triangulation(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        Delaunay_triangulation_2 dt2;
+        triangulate(dt2, workload.points);
+        benchmark::DoNotOptimize(dt2.number_of_vertices());
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// cropping the Voronoi diagram to the bounding box (Cropped_voronoi_from_delaunay)
+void BM_CroppedVoronoi(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::list<Segment_2> segments = getCroppedVoronoi(workload.stages.dt2, workload.stages.bbox);
+        benchmark::DoNotOptimize(segments.size());
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// the convex hull of the points
+void BM_ConvexHull(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        Polygon_2 ch = getConvexHull(workload.points);
+        benchmark::DoNotOptimize(ch.size());
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// keeping the Voronoi vertices inside the convex hull
+void BM_ContainmentFilter(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::vector<Point_2> vertices = getInsideVoronoiVertices(workload.stages.voronoiSegments, workload.stages.ch);
+        benchmark::DoNotOptimize(vertices.data());
+    }
+    finishBenchmark(state, workload.stages.voronoiSegments.size());
+}
+
+// intersecting the Voronoi segments with the edges of the convex hull
+void BM_BoundaryIntersection(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::vector<Point_2> intersections = getHullIntersections(workload.stages.voronoiSegments, workload.stages.chSegments);
+        benchmark::DoNotOptimize(intersections.data());
+    }
+    finishBenchmark(state, workload.stages.voronoiSegments.size());
+}
+
+// the distance from every candidate to its nearest site, walking the triangulation
+void BM_NearestVertexScoring(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::vector<K::FT> scores = scoreCandidatePoints(workload.stages.dt2, workload.stages.candidatePoints);
+        benchmark::DoNotOptimize(scores.data());
+    }
+    finishBenchmark(state, workload.stages.candidatePoints.size());
+}
+
+// every stage, from the points to the circle
+void BM_LargestEmptyCircle(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        LargestEmptyCircle circle = getLargestEmptyCircle(workload.points);
+        benchmark::DoNotOptimize(circle.squaredRadius);
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// the distance from every candidate to its nearest site comparing it with every site (the oracle), the baseline of
+// BM_NearestVertexScoring
+void BM_BruteForceScoring(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::vector<K::FT> scores = scoreCandidatesBruteForce(workload.points, workload.stages.candidatePoints);
+        benchmark::DoNotOptimize(scores.data());
+    }
+    finishBenchmark(state, workload.stages.candidatePoints.size());
+}
+
+// the circle of the oracle, from the points to the circle, the baseline of BM_LargestEmptyCircle
+void BM_BruteForceLargestEmptyCircle(benchmark::State& state) {
+    const Workload& workload = getWorkload(state);
+    for (auto _ : state) {
+        std::vector<LargestEmptyCircle> circles = getBruteForceLargestEmptyCircles(workload.points);
+        benchmark::DoNotOptimize(circles.data());
+    }
+    finishBenchmark(state, workload.points.size());
+}
+
+// the arguments of every benchmark: n from 1024 to 65536 points and every distribution of the generators
+void addArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"n", "distribution"});
+    for (std::int64_t n : {1 << 10, 1 << 13, 1 << 16}) {
+        for (std::size_t distribution = 0; distribution < getPointDistributions().size(); distribution++) benchmark->Args({n, static_cast<std::int64_t>(distribution)});
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// the arguments of the scoring of the oracle, O(n * m) so only the two smaller n
+void addBruteForceScoringArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"n", "distribution"});
+    for (std::int64_t n : {1 << 10, 1 << 13}) {
+        for (std::size_t distribution = 0; distribution < getPointDistributions().size(); distribution++) benchmark->Args({n, static_cast<std::int64_t>(distribution)});
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// the arguments of the whole oracle, with O(n^3) candidates, also used by BM_LargestEmptyCircle to compare them
+void addBruteForceArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"n", "distribution"});
+    for (std::int64_t n : {32, 64, 128}) {
+        for (std::size_t distribution = 0; distribution < getPointDistributions().size(); distribution++) benchmark->Args({n, static_cast<std::int64_t>(distribution)});
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+}
+
+BENCHMARK(BM_Ingest)->Apply(addArguments);
+BENCHMARK(BM_Triangulation)->Apply(addArguments);
+BENCHMARK(BM_CroppedVoronoi)->Apply(addArguments);
+BENCHMARK(BM_ConvexHull)->Apply(addArguments);
+BENCHMARK(BM_ContainmentFilter)->Apply(addArguments);
+BENCHMARK(BM_BoundaryIntersection)->Apply(addArguments);
+BENCHMARK(BM_NearestVertexScoring)->Apply(addArguments);
+BENCHMARK(BM_LargestEmptyCircle)->Apply(addArguments);
+BENCHMARK(BM_BruteForceScoring)->Apply(addBruteForceScoringArguments);
+BENCHMARK(BM_BruteForceLargestEmptyCircle)->Apply(addBruteForceArguments);
+BENCHMARK(BM_LargestEmptyCircle)->Apply(addBruteForceArguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "asyncEngine.h"
+#include "bruteForceOracle.h"
+#include "datasetStore.h"
+#include "geojsonWriter.h"
+#include "outOfCoreLargestEmptyCircle.h"
+#include "largestEmptyCircle.h"
+#include "pointGenerators.h"
+#include "shardedLargestEmptyCircle.h"
+#include "tiledLargestEmptyCircle.h"
+
+// differential runner: solves thousands of small seeded instances of every distribution of the generators (the
+// degenerate ones too) with every mode of the engine and compares their k largest circles with the ones of the brute
+// force oracle, the radii have to be the same, and every circle of the mode has to be empty and centered inside the
+// convex hull. The instances only depend on the seed and their number, so a failing one is solved again with
+// --instance. The output of every instance is also written with GeojsonWriter and parsed back, to check the geojson is
+// valid, and the generators are checked to give the same points with any number of threads
+
+namespace {
+
+// side of the square where the points are generated (the same as lec_bench)
+const double kSide = 1000;
+
+// biggest difference between two radii, relative to the side of the square: the candidates of the modes and of the
+// oracle are constructed in different ways, so they can differ by the rounding of the constructions
+const double kRadiusTolerance = 1e-7;
+
+// prints how to use the program
+void printUsage() {
+    std::cerr << "Usage: lec_differential [--instances N] [--seed S] [--max-sites N] [--top K] [--modes NAME,...] [--instance I] [--verbose]" << std::endl;
+    std::cerr << "Solves --instances (by default 2000) seeded instances of up to --max-sites sites (by default 40) of every" << std::endl;
+    std::cerr << "distribution with the modes of the engine (sequential, threads, tiled, sharded, outofcore, incremental and" << std::endl;
+    std::cerr << "async, by default all of them) and compares their --top (by default 3) largest circles with the brute force" << std::endl;
+    std::cerr << "oracle (the tiled mode only gives the largest one). Exits with 1 if any mode differs." << std::endl;
+    std::cerr << "The geojson output of every instance is also parsed back and checked, and the generators are checked to" << std::endl;
+    std::cerr << "give the same points with any number of threads." << std::endl;
+    std::cerr << "--instance I solves only the instance I of the seed, to reproduce a failure." << std::endl;
+}
+
+// an instance: its sites and how they were generated
+struct Instance {
+    std::size_t number = 0;
+    PointDistribution distribution = PointDistribution::Uniform;
+    std::uint64_t seed = 0;
+    std::vector<Point_2> sites;
+};
+
+// function that returns the instance with the number, its distribution goes round the distributions of the
+// generators and its size and seed are random numbers of the seed of the runner
+Instance makeInstance(std::uint64_t seed, std::size_t number, std::size_t maxSites) {
+    CounterRandom random(seed);
+    std::vector<PointDistribution> distributions = getPointDistributions();
+    Instance instance;
+    instance.number = number;
+    instance.distribution = distributions[number % distributions.size()];
+    instance.seed = random.bits(2 * number);
+    std::size_t n = 3 + random.bits(2 * number + 1) % (std::max<std::size_t>(maxSites, 3) - 2);
+    PointGeneratorOptions options;
+    options.distribution = instance.distribution;
+    options.seed = instance.seed;
+    options.xmax = options.ymax = kSide;
+    // few clusters, so the small instances have empty space between them
+    options.clusters = 3;
+    std::vector<double> coordinates = generatePoints(n, options);
+    for (std::size_t i = 0; i < n; i++) instance.sites.push_back(Point_2(coordinates[2 * i], coordinates[2 * i + 1]));
+    return instance;
+}
+
+// a mode of the engine: its name, the function that returns its k largest empty circles and if it can give more than
+// one circle
+struct Mode {
+    std::string name;
+    std::function<std::vector<LargestEmptyCircle>(const Instance&, std::size_t)> solve;
+    bool top = true;
+};
+
+// function that returns the circles of every stage run one after the other
+std::vector<LargestEmptyCircle> solveSequential(const Instance& instance, std::size_t k) {
+    LargestEmptyCircleStages stages;
+    LargestEmptyCircleOptions options;
+    options.topK = k;
+    runLargestEmptyCircleStages(instance.sites, stages, options);
+    return stages.topCircles;
+}
+
+// function that returns the circles of the stages with 4 threads
+std::vector<LargestEmptyCircle> solveThreads(const Instance& instance, std::size_t k) {
+    LargestEmptyCircleStages stages;
+    LargestEmptyCircleOptions options;
+    options.threads = 4;
+    options.topK = k;
+    runLargestEmptyCircleStages(instance.sites, stages, options);
+    return stages.topCircles;
+}
+
+// function that returns the circle of the tiled mode with a 3 x 3 grid, so most tiles have few sites and grow their
+// halo (the tiled mode only gives the largest circle)
+std::vector<LargestEmptyCircle> solveTiled(const Instance& instance, std::size_t) {
+    TiledLargestEmptyCircleOptions options;
+    options.threads = 2;
+    options.tilesPerSide = 3;
+    options.haloFactor = 1;
+    return {getTiledLargestEmptyCircle(instance.sites, options).circle};
+}
+
+// function that returns the circles of the sharded mode with 2 worker processes
+std::vector<LargestEmptyCircle> solveSharded(const Instance& instance, std::size_t k) {
+    ShardedOptions options;
+    options.processes = 2;
+    options.tilesPerSide = 2;
+    options.topK = k;
+    ShardedLargestEmptyCircle sharded = getShardedLargestEmptyCircle(instance.sites, options);
+    if (sharded.failedTiles > 0 || sharded.circles.empty()) throw std::runtime_error(std::to_string(sharded.failedTiles) + " tiles failed");
+    return sharded.circles;
+}
+
+// function that returns the circles of the out of core mode with a 3 x 3 grid, reading the sites from the instance
+// in both passes
+std::vector<LargestEmptyCircle> solveOutOfCore(const Instance& instance, std::size_t k) {
+    OutOfCoreOptions options;
+    options.tileDirectory = (std::filesystem::temp_directory_path() / ("lec-differential-" + std::to_string(getpid()))).string();
+    options.tilesPerSide = 3;
+    options.topK = k;
+    OutOfCoreLargestEmptyCircle result = getOutOfCoreLargestEmptyCircle([&instance](const std::function<void(const Point_2&)>& callback) {
+        for (const Point_2& site : instance.sites) callback(site);
+    }, options);
+    // the tile files are removed by the mode, the directory is left empty
+    std::error_code error;
+    std::filesystem::remove(options.tileDirectory, error);
+    return result.circles;
+}
+
+// function that returns the circles of a dataset built with the first half of the sites plus a few points that aren't
+// sites, and then updated inserting the other half and removing those points, so the triangulation is changed in
+// place both ways (the circles are the ones of the top query of the server)
+std::vector<LargestEmptyCircle> solveIncremental(const Instance& instance, std::size_t k) {
+    std::size_t half = instance.sites.size() / 2;
+    std::vector<Point_2> first(instance.sites.begin(), instance.sites.begin() + half);
+    std::vector<Point_2> second(instance.sites.begin() + half, instance.sites.end());
+    // with less than 3 sites (or collinear ones) in the first half the dataset is built with all of them
+    if (getBruteForceHull(first).size() < 3) {
+        first = instance.sites;
+        second.clear();
+    }
+    std::vector<Point_2> extra;
+    CounterRandom random(instance.seed);
+    for (std::uint64_t i = 0; extra.size() < 3; i++) {
+        Point_2 point(random.uniform(2 * i) * kSide, random.uniform(2 * i + 1) * kSide);
+        if (std::find(instance.sites.begin(), instance.sites.end(), point) == instance.sites.end()) extra.push_back(point);
+    }
+    std::vector<Point_2> initial(first);
+    initial.insert(initial.end(), extra.begin(), extra.end());
+    std::shared_ptr<Dataset> dataset = makeDataset("differential", initial);
+    std::shared_ptr<Dataset> updated = updateDataset(*dataset, second, extra);
+    return getTopCircles(updated ? *updated : *dataset, k);
+}
+
+// function that returns the circles of a job of the asynchronous engine, run on the calling thread
+std::vector<LargestEmptyCircle> solveAsync(const Instance& instance, std::size_t k) {
+    LargestEmptyCircleJob job;
+    job.points = instance.sites;
+    job.options.topK = k;
+    LargestEmptyCircleJobResult result = runLargestEmptyCircleJob(job);
+    if (result.status != JobStatus::Done) throw std::runtime_error(std::string(getJobStatusName(result.status)) + ": " + result.error);
+    return result.topCircles;
+}
+
+// every mode, in the order they are run
+std::vector<Mode> getModes() {
+    return {{"sequential", solveSequential}, {"threads", solveThreads}, {"tiled", solveTiled, false}, {"sharded", solveSharded}, {"outofcore", solveOutOfCore},
+            {"incremental", solveIncremental}, {"async", solveAsync}};
+}
+
+// function that returns true if the point is inside the convex polygon (counterclockwise) or closer than the
+// tolerance to it, the centers on the edges are constructed so they can be a rounding off the edge
+bool isNearConvexPolygon(const std::vector<Point_2>& polygon, const Point_2& point, double tolerance) {
+    for (std::size_t i = 0; i < polygon.size(); i++) {
+        const Point_2& source = polygon[i];
+        const Point_2& target = polygon[(i + 1) % polygon.size()];
+        if (CGAL::orientation(source, target, point) == CGAL::RIGHT_TURN && CGAL::to_double(CGAL::squared_distance(Line_2(source, target), point)) > tolerance * tolerance) return false;
+    }
+    return true;
+}
+
+// function that returns the first k circles (sorted from the biggest) whose centers are farther than the tolerance from
+// the centers of the ones before, the same center constructed from different sites can be a rounding apart
+std::vector<LargestEmptyCircle> getDistinctCircles(const std::vector<LargestEmptyCircle>& circles, std::size_t k, double tolerance) {
+    std::vector<LargestEmptyCircle> distinct;
+    for (const LargestEmptyCircle& circle : circles) {
+        if (distinct.size() == k) break;
+        bool repeated = std::any_of(distinct.begin(), distinct.end(), [&](const LargestEmptyCircle& other) { return CGAL::to_double(CGAL::squared_distance(other.center, circle.center)) <= tolerance * tolerance; });
+        if (!repeated) distinct.push_back(circle);
+    }
+    return distinct;
+}
+
+// function that checks the circle of a mode against the oracle, returns what is wrong with it (empty if nothing is)
+std::string checkCircle(const Instance& instance, const std::vector<Point_2>& hull, const LargestEmptyCircle& expected, const LargestEmptyCircle& circle) {
+    double tolerance = kRadiusTolerance * kSide;
+    std::ostringstream problem;
+    problem << std::setprecision(17);
+    if (std::abs(circle.radius() - expected.radius()) > tolerance) {
+        problem << "radius " << circle.radius() << " instead of " << expected.radius();
+    } else if (!isNearConvexPolygon(hull, circle.center, tolerance)) {
+        problem << "center " << circle.center << " outside the convex hull";
+    } else {
+        // the nearest site of the center can't be closer than the radius
+        double nearest = std::sqrt(CGAL::to_double(scoreCandidatesBruteForce(instance.sites, {circle.center}).front()));
+        if (nearest < circle.radius() - tolerance) problem << "site at " << nearest << " inside the circle of radius " << circle.radius();
+    }
+    return problem.str();
+}
+
+// function that checks the circles of a mode against the distinct circles of the oracle, returns what is wrong with
+// them (empty if nothing is): the mode has to give the first k circles the oracle has, in the same order and without
+// repeating a center
+std::string checkCircles(const Instance& instance, const std::vector<Point_2>& hull, const std::vector<LargestEmptyCircle>& expected, const std::vector<LargestEmptyCircle>& circles, std::size_t k) {
+    std::size_t asked = std::min(k, expected.size());
+    if (circles.size() < asked) return std::to_string(circles.size()) + " circles instead of " + std::to_string(asked);
+    double tolerance = kRadiusTolerance * kSide;
+    for (std::size_t i = 0; i < std::min(k, circles.size()); i++) {
+        for (std::size_t j = 0; j < i; j++) {
+            if (CGAL::to_double(CGAL::squared_distance(circles[i].center, circles[j].center)) <= tolerance * tolerance) {
+                return "circle " + std::to_string(i + 1) + " repeats the center of circle " + std::to_string(j + 1);
+            }
+        }
+        if (i == expected.size()) return "circle " + std::to_string(i + 1) + " isn't one of the oracle";
+        std::string problem = checkCircle(instance, hull, expected[i], circles[i]);
+        if (!problem.empty()) return "circle " + std::to_string(i + 1) + ": " + problem;
+    }
+    return std::string();
+}
+
+// function that returns true if the json is a position [x, y]
+bool isPosition(const nlohmann::json& position) {
+    return position.is_array() && position.size() == 2 && position[0].is_number() && position[1].is_number();
+}
+
+// function that returns true if the json is an array of at least minimum positions
+bool isPositionArray(const nlohmann::json& positions, std::size_t minimum) {
+    return positions.is_array() && positions.size() >= minimum && std::all_of(positions.begin(), positions.end(), isPosition);
+}
+
+// function that writes the stages of the instance with GeojsonWriter, parses the output back and returns what is
+// wrong with it (empty if nothing is): it has to be a FeatureCollection with every geometry in the shape of its type,
+// and the center has to round trip exactly
+std::string checkGeojsonOutput(const Instance& instance) {
+    LargestEmptyCircleStages stages;
+    runLargestEmptyCircleStages(instance.sites, stages);
+    std::ostringstream out;
+    {
+        GeojsonWriter writer(out);
+        writer.writeCircle(stages.circle);
+        writer.writeSites(instance.sites, "site");
+        writer.writeSegments(stages.voronoiSegments, "voronoi");
+        writer.writeCandidates(stages.candidatePoints, stages.candidateScores);
+    }
+    nlohmann::json collection;
+    try {
+        collection = nlohmann::json::parse(out.str());
+    } catch (const nlohmann::json::exception& error) {
+        return std::string("invalid geojson: ") + error.what();
+    }
+    if (collection.value("type", "") != "FeatureCollection" || !collection["features"].is_array()) return "the output is not a FeatureCollection";
+    std::size_t expectedFeatures = 2 + instance.sites.size() + stages.voronoiSegments.size() + stages.candidatePoints.size();
+    if (collection["features"].size() != expectedFeatures) return std::to_string(collection["features"].size()) + " features instead of " + std::to_string(expectedFeatures);
+    for (const nlohmann::json& feature : collection["features"]) {
+        const nlohmann::json& geometry = feature["geometry"];
+        std::string type = geometry.value("type", "");
+        const nlohmann::json& coordinates = geometry["coordinates"];
+        bool valid = false;
+        if (type == "Point") valid = isPosition(coordinates);
+        else if (type == "LineString") valid = isPositionArray(coordinates, 2);
+        else if (type == "Polygon") {
+            // every ring is closed, with at least 4 positions
+            valid = coordinates.is_array() && !coordinates.empty() && std::all_of(coordinates.begin(), coordinates.end(), [](const nlohmann::json& ring) { return isPositionArray(ring, 4) && ring.front() == ring.back(); });
+        }
+        if (!valid) return "invalid " + type + " geometry " + geometry.dump();
+    }
+    const nlohmann::json& center = collection["features"][0]["geometry"]["coordinates"];
+    if (center[0].get<double>() != CGAL::to_double(stages.circle.center.x()) || center[1].get<double>() != CGAL::to_double(stages.circle.center.y())) return "the center doesn't round trip";
+    return std::string();
+}
+
+
+// function that returns the distributions whose points change with the number of threads that generate them (the
+// generators promise they never do), with enough points for many chunks of the generators
+std::vector<std::string> checkGeneratorThreads(std::uint64_t seed) {
+    std::vector<std::string> differing;
+    for (PointDistribution distribution : getPointDistributions()) {
+        PointGeneratorOptions options;
+        options.distribution = distribution;
+        options.seed = seed;
+        options.xmax = options.ymax = kSide;
+        std::vector<double> sequential = generatePoints(100000, options);
+        for (std::size_t threads : {2, 3, 8}) {
+            options.threads = threads;
+            if (generatePoints(100000, options) != sequential) {
+                differing.push_back(getPointDistributionName(distribution) + " with " + std::to_string(threads) + " threads");
+                break;
+            }
+        }
+    }
+    return differing;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t instances = 2000;
+    std::uint64_t seed = 1;
+    std::size_t maxSites = 40;
+    std::size_t k = 3;
+    bool onlyOne = false, verbose = false;
+    std::size_t onlyInstance = 0;
+    std::vector<Mode> modes = getModes();
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--instances" && i + 1 < argc) instances = std::stoul(argv[++i]);
+        else if (argument == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+        else if (argument == "--max-sites" && i + 1 < argc) maxSites = std::stoul(argv[++i]);
+        else if (argument == "--top" && i + 1 < argc) k = std::max<std::size_t>(1, std::stoul(argv[++i]));
+        else if (argument == "--instance" && i + 1 < argc) {
+            onlyOne = true;
+            onlyInstance = std::stoul(argv[++i]);
+        } else if (argument == "--verbose") verbose = true;
+        else if (argument == "--modes" && i + 1 < argc) {
+            std::vector<Mode> all = getModes();
+            modes.clear();
+            std::istringstream names(argv[++i]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                auto mode = std::find_if(all.begin(), all.end(), [&name](const Mode& m) { return m.name == name; });
+                if (mode == all.end()) {
+                    std::cerr << "Unknown mode " << name << std::endl;
+                    return 2;
+                }
+                modes.push_back(*mode);
+            }
+        } else {
+            printUsage();
+            return argument == "--help" ? 0 : 2;
+        }
+    }
+
+    std::size_t solved = 0, skipped = 0, failures = 0;
+    // the instances are only reproducible if the generators give the same points with any number of threads
+    for (const std::string& differing : checkGeneratorThreads(seed)) {
+        failures++;
+        std::cout << "FAILED generator: the points of " << differing << " are not the ones of 1 thread" << std::endl;
+    }
+    std::size_t first = onlyOne ? onlyInstance : 0;
+    std::size_t last = onlyOne ? onlyInstance + 1 : instances;
+    for (std::size_t number = first; number < last; number++) {
+        Instance instance = makeInstance(seed, number, maxSites);
+        // the engine needs a convex hull with an area, the collinear instances are skipped
+        std::vector<Point_2> hull = getBruteForceHull(instance.sites);
+        if (hull.size() < 3) {
+            skipped++;
+            continue;
+        }
+        // the k largest distinct circles of every candidate of the oracle
+        std::vector<LargestEmptyCircle> expected = getDistinctCircles(getBruteForceLargestEmptyCircles(instance.sites, std::numeric_limits<std::size_t>::max()), k, kRadiusTolerance * kSide);
+        if (verbose) {
+            std::cout << "instance " << number << " (" << getPointDistributionName(instance.distribution) << ", " << instance.sites.size() << " sites): radii" << std::setprecision(17);
+            for (const LargestEmptyCircle& circle : expected) std::cout << ' ' << circle.radius();
+            std::cout << std::endl;
+        }
+        // the output of the engine is also written as geojson and read back
+        std::string geojsonProblem;
+        try {
+            geojsonProblem = checkGeojsonOutput(instance);
+        } catch (const std::exception& error) {
+            geojsonProblem = std::string("threw ") + error.what();
+        }
+        if (!geojsonProblem.empty()) {
+            failures++;
+            std::cout << "FAILED instance " << number << " (" << getPointDistributionName(instance.distribution) << ", " << instance.sites.size() << " sites) geojson output: " << geojsonProblem << std::endl;
+        }
+        for (const Mode& mode : modes) {
+            std::string problem;
+            try {
+                problem = checkCircles(instance, hull, expected, mode.solve(instance, k), mode.top ? k : 1);
+            } catch (const std::exception& error) {
+                problem = std::string("threw ") + error.what();
+            }
+            if (problem.empty()) continue;
+            failures++;
+            std::cout << "FAILED instance " << number << " (" << getPointDistributionName(instance.distribution) << ", " << instance.sites.size() << " sites) mode " << mode.name << ": " << problem << std::endl;
+            std::cout << "  reproduce with: lec_differential --seed " << seed << " --max-sites " << maxSites << " --top " << k << " --instance " << number << " --modes " << mode.name << " --verbose" << std::endl;
+        }
+        solved++;
+    }
+    std::cout << solved << " instances solved with " << modes.size() << " modes, " << skipped << " collinear instances skipped, " << failures << " failures" << std::endl;
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "geojsonReader.h"
+#include "largestEmptyCircle.h"
+#include "pointGenerators.h"
+#include "regionBatch.h"
+
+// scaling and regression harness: runs every stage of the largest empty circle over n = 1e3 ... 1e7 points of every
+// distribution of the generators and over the regions of the data directory, records the wall time of the stages,
+// the throughput, the peak RSS and the number of allocations of every case, and compares them with a baseline JSON
+// file with tolerance bands, exiting with 1 if any case got worse
+
+using json = nlohmann::json;
+
+// every allocation of the program is counted, the global operator new of this executable replaces the default one
+std::atomic<std::uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+// side of the square where the points are generated (the same as lec_bench)
+const double kSide = 1000;
+
+// tolerances of the baseline when the file doesn't give them: a case regresses if a value is bigger than the one of the
+// baseline by more than the fraction, the times below the noise floor (in seconds) are never compared
+const double kDefaultTimeTolerance = 0.25;
+const double kDefaultMemoryTolerance = 0.15;
+const double kDefaultAllocationTolerance = 0.10;
+const double kDefaultNoiseFloor = 0.01;
+
+// prints how to use the program
+void printUsage() {
+    std::cerr << "Usage: lec_scaling [--max-n N] [--distributions NAME,...] [--data DATA_DIRECTORY] [--repetitions N] [--threads N]" << std::endl;
+    std::cerr << "                   [--baseline FILE] [--update-baseline [--counts-only]] [--require-baseline] [--output FILE]" << std::endl;
+    std::cerr << "Runs the largest empty circle over n = 1e3 ... 1e7 (up to --max-n) points of every distribution and over the" << std::endl;
+    std::cerr << "regions of the data directory (by default data, \"none\" skips them), every case in its own process, and" << std::endl;
+    std::cerr << "compares the best wall time of the repetitions (by default 3), the peak RSS and the allocations with the" << std::endl;
+    std::cerr << "baseline (by default bench/baseline.json). Exits with 1 if a case is worse than the baseline by more than" << std::endl;
+    std::cerr << "its tolerance, if its number of points isn't the one of the baseline, or failed. --update-baseline writes" << std::endl;
+    std::cerr << "the measurements as the new baseline, with --counts-only only the points and the allocations, which don't" << std::endl;
+    std::cerr << "depend on the machine. With --require-baseline (for CI) a missing baseline or a case that isn't in it is a" << std::endl;
+    std::cerr << "failure too." << std::endl;
+}
+
+// case of the harness: n points of a distribution or the points of a region
+struct ScalingCase {
+    std::string name;
+    std::size_t n = 0;
+    PointDistribution distribution = PointDistribution::Uniform;
+    // the region, if the case isn't generated
+    bool isRegion = false;
+    Region region;
+};
+
+// options of the harness
+struct ScalingOptions {
+    std::size_t repetitions = 3;
+    std::size_t threads = 1;
+};
+
+// function that returns the points of the case
+std::vector<Point_2> getCasePoints(const ScalingCase& scalingCase) {
+    if (scalingCase.isRegion) return readInputPoints(scalingCase.region.boundaryFilename, scalingCase.region.sitesFilename);
+    PointGeneratorOptions options;
+    options.distribution = scalingCase.distribution;
+    options.seed = scalingCase.n;
+    options.xmax = options.ymax = kSide;
+    std::vector<double> coordinates = generatePoints(scalingCase.n, options);
+    std::vector<Point_2> points;
+    points.reserve(scalingCase.n);
+    for (std::size_t i = 0; i < scalingCase.n; i++) points.push_back(Point_2(coordinates[2 * i], coordinates[2 * i + 1]));
+    return points;
+}
+
+// function that returns the seconds since start
+double getSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// function that measures the case in the calling process and returns the measurements: the best times of the
+// repetitions, and the allocations of the first one
+json measureCase(const ScalingCase& scalingCase, const ScalingOptions& scalingOptions) {
+    json measurement;
+    std::vector<Point_2> points = getCasePoints(scalingCase);
+    LargestEmptyCircleOptions options;
+    options.threads = scalingOptions.threads;
+    double best = 0, bestTriangulation = 0, bestCandidates = 0, bestScore = 0;
+    std::uint64_t caseAllocations = 0;
+    double radius = 0;
+    for (std::size_t repetition = 0; repetition < std::max<std::size_t>(1, scalingOptions.repetitions); repetition++) {
+        std::uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        double triangulationSeconds, candidateSeconds, scoreSeconds;
+        {
+            LargestEmptyCircleStages stages;
+            auto stageStart = std::chrono::steady_clock::now();
+            runTriangulationStage(points, stages, options);
+            triangulationSeconds = getSeconds(stageStart);
+            stageStart = std::chrono::steady_clock::now();
+            runCandidateStage(stages, options);
+            candidateSeconds = getSeconds(stageStart);
+            stageStart = std::chrono::steady_clock::now();
+            runScoreStage(stages, options);
+            scoreSeconds = getSeconds(stageStart);
+            radius = stages.circle.radius();
+        }
+        double seconds = getSeconds(start);
+        if (repetition == 0) caseAllocations = allocations.load(std::memory_order_relaxed) - allocationsBefore;
+        if (repetition == 0 || seconds < best) {
+            best = seconds;
+            bestTriangulation = triangulationSeconds;
+            bestCandidates = candidateSeconds;
+            bestScore = scoreSeconds;
+        }
+    }
+    rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    measurement["points"] = points.size();
+    measurement["seconds"] = best;
+    measurement["triangulationSeconds"] = bestTriangulation;
+    measurement["candidateSeconds"] = bestCandidates;
+    measurement["scoreSeconds"] = bestScore;
+    measurement["pointsPerSecond"] = best > 0 ? points.size() / best : 0.0;
+    // ru_maxrss is in kilobytes on Linux
+    measurement["peakRssBytes"] = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+    measurement["allocations"] = caseAllocations;
+    measurement["radius"] = radius;
+    return measurement;
+}
+
+// function that measures the case in a child process, so its peak RSS is only its own and a crash only fails the case
+json runCase(const ScalingCase& scalingCase, const ScalingOptions& scalingOptions) {
+    int channel[2];
+    if (::pipe(channel) != 0) return json{{"error", "could not create a pipe"}};
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(channel[0]);
+        ::close(channel[1]);
+        return json{{"error", "could not fork"}};
+    }
+    if (pid == 0) {
+        ::close(channel[0]);
+        json measurement;
+        try {
+            measurement = measureCase(scalingCase, scalingOptions);
+        } catch (const std::exception& exception) {
+            measurement = json{{"error", exception.what()}};
+        }
+        std::string record = measurement.dump();
+        for (std::size_t written = 0; written < record.size();) {
+            ssize_t bytes = ::write(channel[1], record.data() + written, record.size() - written);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) break;
+            written += static_cast<std::size_t>(bytes);
+        }
+        _exit(0);
+    }
+    ::close(channel[1]);
+    std::string record;
+    char bytes[4096];
+    while (true) {
+        ssize_t received = ::read(channel[0], bytes, sizeof(bytes));
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        record.append(bytes, static_cast<std::size_t>(received));
+    }
+    ::close(channel[0]);
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || record.empty()) {
+        return json{{"error", WIFSIGNALED(status) ? "the case was killed by signal " + std::to_string(WTERMSIG(status)) : std::string("the case did not report")}};
+    }
+    try {
+        return json::parse(record);
+    } catch (const json::exception&) {
+        return json{{"error", "the case reported an invalid record"}};
+    }
+}
+
+// function that returns the cases: every size up to maxN of every distribution, and every region
+std::vector<ScalingCase> getCases(std::size_t maxN, const std::vector<PointDistribution>& distributions, const std::string& dataDirectory) {
+    std::vector<ScalingCase> cases;
+    for (PointDistribution distribution : distributions) {
+        for (std::size_t n = 1000; n <= maxN && n <= 10000000; n *= 10) {
+            ScalingCase scalingCase;
+            scalingCase.name = getPointDistributionName(distribution) + "/" + std::to_string(n);
+            scalingCase.n = n;
+            scalingCase.distribution = distribution;
+            cases.push_back(scalingCase);
+        }
+    }
+    if (dataDirectory != "none") {
+        for (const Region& region : discoverRegions(dataDirectory)) {
+            ScalingCase scalingCase;
+            scalingCase.name = "region/" + region.name;
+            scalingCase.isRegion = true;
+            scalingCase.region = region;
+            cases.push_back(scalingCase);
+        }
+    }
+    return cases;
+}
+
+// function that returns the value of the tolerance from the baseline, or the default one
+double getTolerance(const json& baseline, const char* key, double fallback) {
+    if (baseline.contains("tolerance") && baseline["tolerance"].contains(key)) return baseline["tolerance"][key].get<double>();
+    return fallback;
+}
+
+// function that compares a measured value with the one of the baseline, returns true if it regressed and adds a
+// description of the change to notes when it's outside the band (worse or better)
+bool compareValue(const json& measured, const json& expected, const char* key, double tolerance, double floor, std::vector<std::string>& notes) {
+    if (!expected.contains(key) || !measured.contains(key)) return false;
+    double value = measured[key].get<double>(), reference = expected[key].get<double>();
+    if (reference <= 0 || std::max(value, reference) < floor) return false;
+    double change = value / reference - 1;
+    if (std::abs(change) <= tolerance) return false;
+    std::ostringstream note;
+    note << key << ' ' << std::showpos << std::fixed << std::setprecision(1) << 100 * change << '%';
+    notes.push_back(note.str());
+    return change > 0;
+}
+
+// function that returns true if the number of points of the case isn't the one of the baseline, then the generators
+// or the reader changed and the other values can't be compared, it adds a description to notes
+bool comparePoints(const json& measured, const json& expected, std::vector<std::string>& notes) {
+    if (!expected.contains("points") || !measured.contains("points")) return false;
+    std::size_t value = measured["points"].get<std::size_t>(), reference = expected["points"].get<std::size_t>();
+    if (value == reference) return false;
+    notes.push_back("points " + std::to_string(value) + " instead of " + std::to_string(reference));
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t maxN = 10000000;
+    std::vector<PointDistribution> distributions = getPointDistributions();
+    std::string dataDirectory = "data";
+    std::string baselineFilename = "bench/baseline.json";
+    std::string outputFilename;
+    bool updateBaseline = false;
+    bool countsOnly = false;
+    bool requireBaseline = false;
+    ScalingOptions scalingOptions;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--max-n" && i + 1 < argc) maxN = static_cast<std::size_t>(std::stod(argv[++i]));
+        else if (argument == "--data" && i + 1 < argc) dataDirectory = argv[++i];
+        else if (argument == "--repetitions" && i + 1 < argc) scalingOptions.repetitions = std::stoul(argv[++i]);
+        else if (argument == "--threads" && i + 1 < argc) scalingOptions.threads = std::stoul(argv[++i]);
+        else if (argument == "--baseline" && i + 1 < argc) baselineFilename = argv[++i];
+        else if (argument == "--output" && i + 1 < argc) outputFilename = argv[++i];
+        else if (argument == "--update-baseline") updateBaseline = true;
+        else if (argument == "--counts-only") countsOnly = true;
+        else if (argument == "--require-baseline") requireBaseline = true;
+        else if (argument == "--distributions" && i + 1 < argc) {
+            distributions.clear();
+            std::istringstream names(argv[++i]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                PointDistribution distribution;
+                if (!parsePointDistribution(name, distribution)) {
+                    std::cerr << "Unknown distribution " << name << std::endl;
+                    return 2;
+                }
+                distributions.push_back(distribution);
+            }
+        } else {
+            printUsage();
+            return argument == "--help" ? 0 : 2;
+        }
+    }
+
+    // a missing baseline only has the default tolerances, so every case is new (an error with --require-baseline,
+    // where a case can't pass without being compared)
+    json baseline = json::object();
+    {
+        std::ifstream file(baselineFilename);
+        if (file) {
+            try {
+                file >> baseline;
+            } catch (const json::exception& error) {
+                std::cerr << "Could not read the baseline " << baselineFilename << ": " << error.what() << std::endl;
+                return 2;
+            }
+        } else if (requireBaseline && !updateBaseline) {
+            std::cerr << "No baseline at " << baselineFilename << std::endl;
+            return 2;
+        } else if (!updateBaseline) {
+            std::cerr << "No baseline at " << baselineFilename << ", the cases are only measured" << std::endl;
+        }
+    }
+    double timeTolerance = getTolerance(baseline, "seconds", kDefaultTimeTolerance);
+    double memoryTolerance = getTolerance(baseline, "peakRssBytes", kDefaultMemoryTolerance);
+    double allocationTolerance = getTolerance(baseline, "allocations", kDefaultAllocationTolerance);
+    double noiseFloor = getTolerance(baseline, "noiseFloorSeconds", kDefaultNoiseFloor);
+    json expectedCases = baseline.contains("cases") ? baseline["cases"] : json::object();
+
+    std::vector<ScalingCase> cases = getCases(maxN, distributions, dataDirectory);
+    json results = json::object();
+    std::size_t regressions = 0, failures = 0, missing = 0;
+    std::cout << std::left << std::setw(28) << "case" << std::right << std::setw(10) << "points" << std::setw(12) << "seconds" << std::setw(14) << "Mpoints/s"
+              << std::setw(12) << "RSS MB" << std::setw(14) << "allocations" << "  status" << std::endl;
+    for (const ScalingCase& scalingCase : cases) {
+        json measured = runCase(scalingCase, scalingOptions);
+        results[scalingCase.name] = measured;
+        std::cout << std::left << std::setw(28) << scalingCase.name << std::right;
+        if (measured.contains("error")) {
+            std::cout << "  failed: " << measured["error"].get<std::string>() << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << std::setw(10) << measured["points"].get<std::size_t>() << std::fixed << std::setprecision(4) << std::setw(12) << measured["seconds"].get<double>()
+                  << std::setprecision(3) << std::setw(14) << measured["pointsPerSecond"].get<double>() / 1e6 << std::setprecision(1) << std::setw(12)
+                  << measured["peakRssBytes"].get<double>() / (1 << 20) << std::setw(14) << measured["allocations"].get<std::uint64_t>();
+        std::cout.unsetf(std::ios::fixed);
+
+        // the total time and the times of the stages that are optimized are compared, with the memory and the
+        // allocations
+        std::string status = "new";
+        if (expectedCases.contains(scalingCase.name)) {
+            const json& expected = expectedCases[scalingCase.name];
+            std::vector<std::string> notes;
+            bool regressed = comparePoints(measured, expected, notes);
+            for (const char* key : {"seconds", "triangulationSeconds", "candidateSeconds"}) regressed |= compareValue(measured, expected, key, timeTolerance, noiseFloor, notes);
+            regressed |= compareValue(measured, expected, "peakRssBytes", memoryTolerance, 0, notes);
+            regressed |= compareValue(measured, expected, "allocations", allocationTolerance, 0, notes);
+            status = regressed ? "REGRESSION" : "ok";
+            for (const std::string& note : notes) status += " " + note;
+            if (regressed) regressions++;
+        } else if (requireBaseline && !updateBaseline) {
+            // a case the baseline doesn't have would always pass, so it fails instead
+            status = "MISSING";
+            missing++;
+        }
+        std::cout << "  " << status << std::endl;
+    }
+
+    if (!outputFilename.empty()) {
+        std::ofstream output(outputFilename);
+        output << json{{"cases", results}}.dump(2) << '\n';
+    }
+    if (updateBaseline) {
+        // the tolerances are kept, the cases that weren't run this time too, with --counts-only the times and the
+        // memory of the cases in the baseline are kept too (they belong to the reference machine)
+        json updated = baseline;
+        updated["tolerance"] = {{"seconds", timeTolerance}, {"peakRssBytes", memoryTolerance}, {"allocations", allocationTolerance}, {"noiseFloorSeconds", noiseFloor}};
+        if (!updated.contains("cases")) updated["cases"] = json::object();
+        for (auto& result : results.items()) {
+            if (result.value().contains("error")) continue;
+            if (!countsOnly) {
+                updated["cases"][result.key()] = result.value();
+                continue;
+            }
+            for (const char* key : {"points", "allocations"}) updated["cases"][result.key()][key] = result.value()[key];
+        }
+        std::ofstream file(baselineFilename);
+        file << updated.dump(2) << '\n';
+        if (!file) {
+            std::cerr << "Could not write the baseline " << baselineFilename << std::endl;
+            return 2;
+        }
+        std::cerr << "Baseline written to " << baselineFilename << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+
+    std::cerr << cases.size() << " cases, " << regressions << " regressions, " << failures << " failed";
+    if (requireBaseline) std::cerr << ", " << missing << " not in the baseline";
+    std::cerr << std::endl;
+    return regressions == 0 && failures == 0 && missing == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "asyncEngine.h"
+#include "geojsonReader.h"
+#include <chrono>
+#include <exception>
+#include <memory>
+
+// function that returns the name of a job status
+const char* getJobStatusName(JobStatus status) {
+    switch (status) {
+        case JobStatus::Done: return "done";
+        case JobStatus::Cancelled: return "cancelled";
+        case JobStatus::DeadlineExceeded: return "deadline exceeded";
+        case JobStatus::Failed: return "failed";
+    }
+    return "unknown";
+}
+
+// function that runs a job on the calling thread, checking its token between the stages and inside their loops
+LargestEmptyCircleJobResult runLargestEmptyCircleJob(const LargestEmptyCircleJob& job) {
+    LargestEmptyCircleJobResult result;
+    LargestEmptyCircleOptions options = job.options;
+    options.cancellation = &job.cancellation;
+    try {
+        // a job cancelled (or out of time) while it waited is not started
+        job.cancellation.check();
+        std::vector<Point_2> filePoints;
+        if (job.points.empty() && !job.boundaryFilename.empty()) {
+            filePoints = readInputPoints(job.boundaryFilename, job.sitesFilename);
+            job.cancellation.check();
+        }
+        const std::vector<Point_2>& points = job.points.empty() ? filePoints : job.points;
+        result.numberOfPoints = points.size();
+        if (points.size() < 3) throw std::runtime_error("at least 3 points are needed");
+
+        LargestEmptyCircleStages stages;
+        runLargestEmptyCircleStages(points, stages, options);
+        result.circle = stages.circle;
+        result.topCircles = stages.topCircles;
+        result.profile = stages.profile;
+        result.status = JobStatus::Done;
+    } catch (const OperationCancelled& cancelled) {
+        result.status = cancelled.expired() ? JobStatus::DeadlineExceeded : JobStatus::Cancelled;
+        result.error = cancelled.what();
+    } catch (const std::exception& exception) {
+        result.status = JobStatus::Failed;
+        result.error = exception.what();
+    }
+    return result;
+}
+
+// adds a job and returns the future of its result (the future never holds an exception)
+std::future<LargestEmptyCircleJobResult> AsyncLargestEmptyCircleEngine::submit(LargestEmptyCircleJob job) {
+    // the promise and the job are shared with the task, because the tasks of the pool must be copyable
+    std::shared_ptr<std::promise<LargestEmptyCircleJobResult>> promise = std::make_shared<std::promise<LargestEmptyCircleJobResult>>();
+    std::shared_ptr<LargestEmptyCircleJob> sharedJob = std::make_shared<LargestEmptyCircleJob>(std::move(job));
+    std::future<LargestEmptyCircleJobResult> future = promise->get_future();
+    auto submitted = std::chrono::steady_clock::now();
+    m_pool.submit([promise, sharedJob, submitted]() {
+        LargestEmptyCircleJobResult result = runLargestEmptyCircleJob(*sharedJob);
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - submitted).count();
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
@@ -0,0 +1,67 @@
+#ifndef ASYNC_ENGINE_H
+#define ASYNC_ENGINE_H
+
+#include <cstddef>
+#include <future>
+#include <string>
+#include <vector>
+#include "cancellation.h"
+#include "largestEmptyCircle.h"
+#include "threadPool.h"
+
+// job for the asynchronous engine: the points, or the geojson files to read them from if there are no points
+struct LargestEmptyCircleJob {
+    std::vector<Point_2> points;
+    std::string boundaryFilename;
+    std::string sitesFilename;
+    // threads and number of circles of the computation (its cancellation token is replaced by the job's one)
+    LargestEmptyCircleOptions options;
+    // token to cancel the job or give it a deadline, also checked while the job waits in the queue
+    CancellationToken cancellation;
+};
+
+// how a job ended
+enum class JobStatus { Done, Cancelled, DeadlineExceeded, Failed };
+
+// result of a job of the asynchronous engine
+struct LargestEmptyCircleJobResult {
+    JobStatus status = JobStatus::Failed;
+    // why the job failed (empty if it's done)
+    std::string error;
+    // the largest empty circle and the best topK circles
+    LargestEmptyCircle circle;
+    std::vector<LargestEmptyCircle> topCircles;
+    std::size_t numberOfPoints = 0;
+    // time from the submission to the end of the job
+    double seconds = 0;
+    // the times and counters of the stages (all zero without LEC_PROFILE)
+    StageProfile profile;
+};
+
+// function that returns the name of a job status
+const char* getJobStatusName(JobStatus status);
+
+// engine that runs the jobs on its own worker threads and returns a future for every job, so it can be embedded in
+// a service without blocking it, nothing is printed: the errors come back in the result
+class AsyncLargestEmptyCircleEngine {
+public:
+    // constructor that starts the workers (by default one per hardware thread)
+    explicit AsyncLargestEmptyCircleEngine(std::size_t workers = 0) : m_pool(workers) {}
+
+    // adds a job and returns the future of its result (the future never holds an exception)
+    std::future<LargestEmptyCircleJobResult> submit(LargestEmptyCircleJob job);
+
+    // waits until every submitted job has finished
+    void wait() { m_pool.wait(); }
+
+    // the number of workers
+    std::size_t size() const { return m_pool.size(); }
+
+private:
+    ThreadPool m_pool;
+};
+
+// function that runs a job on the calling thread, checking its token between the stages and inside their loops
+LargestEmptyCircleJobResult runLargestEmptyCircleJob(const LargestEmptyCircleJob& job);
+
+#endif
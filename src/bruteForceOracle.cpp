@@ -0,0 +1,117 @@
+#include "bruteForceOracle.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <limits>
+
+// function that returns the convex hull of the sites counterclockwise, without repeated or collinear vertices
+// (Andrew's monotone chain), it has less than 3 vertices if the sites are collinear
+std::vector<Point_2> getBruteForceHull(const std::vector<Point_2>& sites) {
+    std::vector<Point_2> points(sites);
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    if (points.size() < 3) return points;
+    // the lower chain from left to right and the upper one back, a vertex that isn't a left turn is removed
+    std::vector<Point_2> hull(2 * points.size());
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        while (size >= 2 && CGAL::orientation(hull[size - 2], hull[size - 1], points[i]) != CGAL::LEFT_TURN) size--;
+        hull[size++] = points[i];
+    }
+    for (std::size_t i = points.size() - 1, lower = size + 1; i-- > 0;) {
+        while (size >= lower && CGAL::orientation(hull[size - 2], hull[size - 1], points[i]) != CGAL::LEFT_TURN) size--;
+        hull[size++] = points[i];
+    }
+    // the first vertex was added again at the end
+    hull.resize(size - 1);
+    return hull;
+}
+
+// function that returns true if the point is inside the convex polygon (counterclockwise) or on its boundary
+bool isInsideConvexPolygon(const std::vector<Point_2>& polygon, const Point_2& point) {
+    for (std::size_t i = 0; i < polygon.size(); i++) {
+        if (CGAL::orientation(polygon[i], polygon[(i + 1) % polygon.size()], point) == CGAL::RIGHT_TURN) return false;
+    }
+    return true;
+}
+
+// function that returns true if no site is inside the circle, the sites closer than the radius by less than a relative
+// tolerance are on it (the center is a rounded construction)
+bool isEmptyCircleBruteForce(const std::vector<Point_2>& sites, const Point_2& center, const K::FT& squaredRadius) {
+    K::FT inner = squaredRadius * (1 - 1e-9);
+    for (const Point_2& site : sites) {
+        if (CGAL::squared_distance(center, site) < inner) return false;
+    }
+    return true;
+}
+
+// function that returns the candidates of the oracle: the circumcenters of the triples of sites that are inside the
+// convex hull, and the intersections of the bisectors of the pairs of sites with the edges of the convex hull, whose
+// circles through their sites are empty, sorted and without repeated centers
+std::vector<Point_2> getBruteForceCandidates(const std::vector<Point_2>& sites, std::size_t threads) {
+    std::vector<Point_2> points(sites);
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    std::vector<Point_2> hull = getBruteForceHull(points);
+    if (hull.size() < 3) return std::vector<Point_2>();
+
+    // every first site of the triples and of the pairs is handled by a thread, the candidates are joined in order
+    std::vector<std::vector<Point_2>> firstCandidates(points.size());
+    parallelFor(points.size(), 1, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t i = begin; i < end; i++) {
+            std::vector<Point_2>& candidates = firstCandidates[i];
+            for (std::size_t j = i + 1; j < points.size(); j++) {
+                // the circumcenters of the triples that aren't collinear
+                for (std::size_t l = j + 1; l < points.size(); l++) {
+                    if (CGAL::collinear(points[i], points[j], points[l])) continue;
+                    Point_2 center = CGAL::circumcenter(points[i], points[j], points[l]);
+                    if (isInsideConvexPolygon(hull, center) && isEmptyCircleBruteForce(points, center, CGAL::squared_distance(center, points[i]))) candidates.push_back(center);
+                }
+                // the bisector of the pair cut by the edges of the hull
+                Line_2 bisector = CGAL::bisector(points[i], points[j]);
+                for (std::size_t e = 0; e < hull.size(); e++) {
+                    Segment_2 edge(hull[e], hull[(e + 1) % hull.size()]);
+                    CGAL::Object obj = CGAL::intersection(bisector, edge);
+                    const Point_2* p = CGAL::object_cast<Point_2>(&obj);
+                    if (p && isEmptyCircleBruteForce(points, *p, CGAL::squared_distance(*p, points[i]))) candidates.push_back(*p);
+                }
+            }
+        }
+    });
+    std::vector<Point_2> candidates;
+    for (const std::vector<Point_2>& first : firstCandidates) candidates.insert(candidates.end(), first.begin(), first.end());
+    // the triples of sites on the same circle (and the pairs whose bisector crosses a vertex of the hull) give the same
+    // center, it's only kept once so the k largest circles are k different ones
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+// function that returns the squared distance from every candidate to its nearest site, comparing it with every site
+std::vector<K::FT> scoreCandidatesBruteForce(const std::vector<Point_2>& sites, const std::vector<Point_2>& candidates, std::size_t threads) {
+    std::vector<K::FT> scores(candidates.size());
+    parallelFor(candidates.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t i = begin; i < end; i++) {
+            K::FT best = std::numeric_limits<double>::infinity();
+            for (const Point_2& site : sites) best = std::min(best, CGAL::squared_distance(candidates[i], site));
+            scores[i] = best;
+        }
+    });
+    return scores;
+}
+
+// function that returns the k largest empty circles of the sites found by the oracle, from the biggest to the
+// smallest (empty if the sites are collinear)
+std::vector<LargestEmptyCircle> getBruteForceLargestEmptyCircles(const std::vector<Point_2>& sites, std::size_t k, std::size_t threads) {
+    std::vector<Point_2> candidates = getBruteForceCandidates(sites, threads);
+    std::vector<K::FT> scores = scoreCandidatesBruteForce(sites, candidates, threads);
+    std::vector<LargestEmptyCircle> circles;
+    for (std::size_t i = 0; i < candidates.size(); i++) {
+        LargestEmptyCircle circle;
+        circle.center = candidates[i];
+        circle.squaredRadius = scores[i];
+        circles.push_back(circle);
+    }
+    std::sort(circles.begin(), circles.end(), isBetterCircle);
+    if (circles.size() > k) circles.resize(k);
+    return circles;
+}
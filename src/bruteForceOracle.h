@@ -0,0 +1,39 @@
+#ifndef BRUTE_FORCE_ORACLE_H
+#define BRUTE_FORCE_ORACLE_H
+
+#include <cstddef>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// reference oracle of the largest empty circle, written to be obviously right instead of fast: it doesn't use the
+// triangulation, the Voronoi diagram or the convex hull of the engine. Its candidates are the ones of the engine found
+// by their definition, the circumcenter of every triple of sites inside the convex hull and the intersection of the
+// bisector of every pair of sites with every edge of the convex hull, kept if no site is inside their circle (so the k
+// largest circles are the k largest local ones, like the engine's), and every candidate is scored against every site,
+// so it takes O(n^4) distances for n sites. It's the reference of the differential runner (lec_differential) and the
+// speed baseline of lec_bench
+
+// function that returns the convex hull of the sites counterclockwise, without repeated or collinear vertices
+// (Andrew's monotone chain), it has less than 3 vertices if the sites are collinear
+std::vector<Point_2> getBruteForceHull(const std::vector<Point_2>& sites);
+
+// function that returns true if the point is inside the convex polygon (counterclockwise) or on its boundary
+bool isInsideConvexPolygon(const std::vector<Point_2>& polygon, const Point_2& point);
+
+// function that returns true if no site is inside the circle, the sites closer than the radius by less than a relative
+// tolerance are on it (the center is a rounded construction)
+bool isEmptyCircleBruteForce(const std::vector<Point_2>& sites, const Point_2& center, const K::FT& squaredRadius);
+
+// function that returns the candidates of the oracle: the circumcenters of the triples of sites that are inside the
+// convex hull, and the intersections of the bisectors of the pairs of sites with the edges of the convex hull, whose
+// circles through their sites are empty, sorted and without repeated centers
+std::vector<Point_2> getBruteForceCandidates(const std::vector<Point_2>& sites, std::size_t threads = 1);
+
+// function that returns the squared distance from every candidate to its nearest site, comparing it with every site
+std::vector<K::FT> scoreCandidatesBruteForce(const std::vector<Point_2>& sites, const std::vector<Point_2>& candidates, std::size_t threads = 1);
+
+// function that returns the k largest empty circles of the sites found by the oracle, from the biggest to the
+// smallest (empty if the sites are collinear)
+std::vector<LargestEmptyCircle> getBruteForceLargestEmptyCircles(const std::vector<Point_2>& sites, std::size_t k = 1, std::size_t threads = 1);
+
+#endif
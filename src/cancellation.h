@@ -0,0 +1,55 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// exception thrown by a computation that was cancelled or ran out of time
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled(const std::string& message, bool expired) : std::runtime_error(message), m_expired(expired) {}
+
+    // true if the deadline passed, false if it was cancelled
+    bool expired() const { return m_expired; }
+
+private:
+    bool m_expired;
+};
+
+// token shared by whoever may cancel a computation and the computation itself, the copies of a token share its
+// state, the computation checks it between its stages and every some iterations of its long loops
+class CancellationToken {
+public:
+    CancellationToken() : m_state(std::make_shared<State>()) {}
+
+    // asks the computation to stop
+    void cancel() { m_state->cancelled = true; }
+
+    // sets the time after which the computation stops by itself (set it before the computation starts)
+    void setDeadline(std::chrono::steady_clock::time_point deadline) { m_state->deadline = deadline; }
+    std::chrono::steady_clock::time_point deadline() const { return m_state->deadline; }
+
+    bool isCancelled() const { return m_state->cancelled; }
+    bool isExpired() const { return std::chrono::steady_clock::now() >= m_state->deadline; }
+
+    // true if the computation must stop
+    bool shouldStop() const { return isCancelled() || isExpired(); }
+
+    // throws OperationCancelled if the computation must stop
+    void check() const {
+        if (isCancelled()) throw OperationCancelled("cancelled", false);
+        if (isExpired()) throw OperationCancelled("deadline exceeded", true);
+    }
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    };
+    std::shared_ptr<State> m_state;
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include "compressedStream.h"
+#include <cstring>
+#include <vector>
+#ifdef LEC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LEC_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// size of the blocks read from the files and of the chunks handed to the parser
+const std::size_t kChunkSize = 1 << 18;
+// number of chunks that can wait in the queue before the reading thread blocks
+const std::size_t kQueueCapacity = 8;
+
+// function that reads the file in blocks and pushes them as they are
+void copyChunks(std::FILE* file, ChunkQueue& queue) {
+    std::string chunk(kChunkSize, '\0');
+    std::size_t read;
+    while ((read = std::fread(&chunk[0], 1, kChunkSize, file)) > 0) {
+        chunk.resize(read);
+        if (!queue.push(std::move(chunk))) return;
+        chunk.assign(kChunkSize, '\0');
+    }
+    queue.finish(std::ferror(file) ? "read error" : "");
+}
+
+#ifdef LEC_HAVE_ZLIB
+// function that decompresses a gzip file (concatenated members included) and pushes the decompressed chunks
+void inflateChunks(std::FILE* file, ChunkQueue& queue) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // 15 + 32: the biggest window with automatic detection of the gzip/zlib header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        queue.finish("could not start the gzip decompression");
+        return;
+    }
+    std::vector<unsigned char> input(kChunkSize);
+    std::string chunk(kChunkSize, '\0');
+    int status = Z_OK;
+    std::string error;
+    bool closed = false;
+    while (!closed && error.empty()) {
+        stream.avail_in = static_cast<uInt>(std::fread(input.data(), 1, input.size(), file));
+        stream.next_in = input.data();
+        if (stream.avail_in == 0) {
+            if (status != Z_STREAM_END) error = std::ferror(file) ? "read error" : "truncated gzip stream";
+            break;
+        }
+        // all the input block is decompressed (a full output chunk means there may be more output pending, unless the
+        // member ended: then its output is complete, and inflating again without input would only give Z_BUF_ERROR and
+        // lose the end of the member)
+        bool outputFull = false;
+        while ((stream.avail_in > 0 || (outputFull && status != Z_STREAM_END)) && error.empty()) {
+            // a new gzip member starts after the end of the previous one, only if there is input left for it
+            if (status == Z_STREAM_END) inflateReset(&stream);
+            stream.next_out = reinterpret_cast<unsigned char*>(&chunk[0]);
+            stream.avail_out = static_cast<uInt>(chunk.size());
+            status = inflate(&stream, Z_NO_FLUSH);
+            if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+                error = stream.msg ? stream.msg : "corrupted gzip stream";
+                break;
+            }
+            std::size_t produced = chunk.size() - stream.avail_out;
+            outputFull = stream.avail_out == 0;
+            if (produced > 0) {
+                chunk.resize(produced);
+                if (!queue.push(std::move(chunk))) {
+                    closed = true;
+                    break;
+                }
+                chunk.assign(kChunkSize, '\0');
+            }
+        }
+    }
+    inflateEnd(&stream);
+    queue.finish(error);
+}
+#endif
+
+#ifdef LEC_HAVE_ZSTD
+// function that decompresses a zstd file (concatenated frames included) and pushes the decompressed chunks
+void decompressZstdChunks(std::FILE* file, ChunkQueue& queue) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    std::vector<char> input(ZSTD_DStreamInSize());
+    std::string chunk(ZSTD_DStreamOutSize(), '\0');
+    std::string error;
+    std::size_t lastResult = 0;
+    bool closed = false;
+    std::size_t read;
+    while (!closed && error.empty() && (read = std::fread(input.data(), 1, input.size(), file)) > 0) {
+        ZSTD_inBuffer in = {input.data(), read, 0};
+        // all the input block is decompressed (a full output chunk means there may be more output pending)
+        bool outputFull = false;
+        while (in.pos < in.size || outputFull) {
+            ZSTD_outBuffer out = {&chunk[0], chunk.size(), 0};
+            lastResult = ZSTD_decompressStream(context, &out, &in);
+            if (ZSTD_isError(lastResult)) {
+                error = ZSTD_getErrorName(lastResult);
+                break;
+            }
+            outputFull = out.pos == out.size;
+            if (out.pos > 0) {
+                chunk.resize(out.pos);
+                if (!queue.push(std::move(chunk))) {
+                    closed = true;
+                    break;
+                }
+                chunk.assign(ZSTD_DStreamOutSize(), '\0');
+            }
+        }
+    }
+    // a result different from 0 at the end means the last frame is incomplete
+    if (error.empty() && !closed && lastResult != 0) error = "truncated zstd stream";
+    ZSTD_freeDCtx(context);
+    queue.finish(error);
+}
+#endif
+
+}
+
+// function that returns the compression of a file from its first bytes (gzip: 1f 8b, zstd: 28 b5 2f fd)
+Compression detectCompression(const unsigned char* bytes, std::size_t size) {
+    if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) return Compression::Gzip;
+    if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd) return Compression::Zstd;
+    return Compression::None;
+}
+
+// function that returns the compression of an output file from its extension (.gz or .zst)
+Compression compressionFromExtension(const std::string& filename) {
+    auto endsWith = [&filename](const std::string& extension) {
+        return filename.size() >= extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+    };
+    if (endsWith(".gz")) return Compression::Gzip;
+    if (endsWith(".zst")) return Compression::Zstd;
+    return Compression::None;
+}
+
+// adds a chunk, returns false if the consumer closed the queue
+bool ChunkQueue::push(std::string&& chunk) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_closed || m_chunks.size() < m_capacity; });
+    if (m_closed) return false;
+    m_chunks.push_back(std::move(chunk));
+    m_notEmpty.notify_one();
+    return true;
+}
+
+// takes the next chunk, returns false when the producer finished and the queue is empty
+bool ChunkQueue::pop(std::string& chunk) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this] { return m_finished || m_closed || !m_chunks.empty(); });
+    if (m_chunks.empty()) return false;
+    chunk = std::move(m_chunks.front());
+    m_chunks.pop_front();
+    m_notFull.notify_one();
+    return true;
+}
+
+// the producer calls it when there are no more chunks (with an error message if it failed)
+void ChunkQueue::finish(const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished = true;
+    m_error = error;
+    m_notEmpty.notify_all();
+}
+
+// the consumer calls it to stop the producer
+void ChunkQueue::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+}
+
+// the error message of the producer, empty if there wasn't an error
+std::string ChunkQueue::error() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+DecompressingInputStream::DecompressingInputStream(const std::string& filename)
+    :std::istream(nullptr), m_queue(kQueueCapacity), m_streambuf(m_queue) {
+    rdbuf(&m_streambuf);
+    m_file = std::fopen(filename.c_str(), "rb");
+    if (!m_file) {
+        setstate(std::ios::failbit);
+        return;
+    }
+    // the magic bytes are read and the file is rewound, the reading thread starts from the beginning
+    unsigned char magic[4];
+    std::size_t read = std::fread(magic, 1, sizeof(magic), m_file);
+    m_compression = detectCompression(magic, read);
+    std::rewind(m_file);
+    m_thread = std::thread(&DecompressingInputStream::produce, this);
+}
+
+DecompressingInputStream::~DecompressingInputStream() {
+    // the reading thread is stopped if the parser didn't read the whole file
+    m_queue.close();
+    if (m_thread.joinable()) m_thread.join();
+    if (m_file) std::fclose(m_file);
+}
+
+// body of the reading thread
+void DecompressingInputStream::produce() {
+    switch (m_compression) {
+    case Compression::None:
+        copyChunks(m_file, m_queue);
+        break;
+    case Compression::Gzip:
+#ifdef LEC_HAVE_ZLIB
+        inflateChunks(m_file, m_queue);
+#else
+        m_queue.finish("gzip input but the program was built without zlib");
+#endif
+        break;
+    case Compression::Zstd:
+#ifdef LEC_HAVE_ZSTD
+        decompressZstdChunks(m_file, m_queue);
+#else
+        m_queue.finish("zstd input but the program was built without zstd");
+#endif
+        break;
+    }
+}
+
+DecompressingInputStream::QueueStreambuf::int_type DecompressingInputStream::QueueStreambuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    // the next chunk replaces the one that was consumed
+    if (!m_queue.pop(m_chunk)) return traits_type::eof();
+    setg(&m_chunk[0], &m_chunk[0], &m_chunk[0] + m_chunk.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+// streambuf that compresses its buffer every time it fills up and writes the result to the file
+class CompressingOutputStream::CompressingStreambuf : public std::streambuf {
+public:
+    explicit CompressingStreambuf(const std::string& filename):m_buffer(kChunkSize), m_output(kChunkSize) {
+        m_compression = compressionFromExtension(filename);
+        m_file = std::fopen(filename.c_str(), "wb");
+        if (!m_file) return;
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+        switch (m_compression) {
+        case Compression::None:
+            break;
+        case Compression::Gzip:
+#ifdef LEC_HAVE_ZLIB
+            std::memset(&m_gzip, 0, sizeof(m_gzip));
+            // 15 + 16: the biggest window with a gzip header
+            m_ok = deflateInit2(&m_gzip, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+#else
+            m_ok = false;
+#endif
+            break;
+        case Compression::Zstd:
+#ifdef LEC_HAVE_ZSTD
+            m_zstd = ZSTD_createCCtx();
+            m_ok = m_zstd != nullptr;
+#else
+            m_ok = false;
+#endif
+            break;
+        }
+    }
+
+    ~CompressingStreambuf() { close(); }
+
+    bool isOpen() const { return m_file != nullptr && m_ok; }
+
+    // compresses what is left, ends the compressed stream and closes the file
+    bool close() {
+        if (!m_file) return m_ok;
+        compress(true);
+#ifdef LEC_HAVE_ZLIB
+        if (m_compression == Compression::Gzip) deflateEnd(&m_gzip);
+#endif
+#ifdef LEC_HAVE_ZSTD
+        if (m_zstd) ZSTD_freeCCtx(m_zstd);
+        m_zstd = nullptr;
+#endif
+        if (std::fclose(m_file) != 0) m_ok = false;
+        m_file = nullptr;
+        return m_ok;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!m_file || !compress(false)) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    // the buffer is compressed but the compressed stream is not flushed, that would hurt the compression ratio
+    int sync() override { return m_file && compress(false) ? 0 : -1; }
+
+private:
+    // compresses the pending bytes of the buffer and writes the output, ending the stream if last is true
+    bool compress(bool last) {
+        std::size_t pending = pptr() - pbase();
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+        if (!m_ok) return false;
+        switch (m_compression) {
+        case Compression::None:
+            if (std::fwrite(m_buffer.data(), 1, pending, m_file) != pending) m_ok = false;
+            break;
+        case Compression::Gzip:
+#ifdef LEC_HAVE_ZLIB
+        {
+            m_gzip.next_in = reinterpret_cast<unsigned char*>(m_buffer.data());
+            m_gzip.avail_in = static_cast<uInt>(pending);
+            int status;
+            do {
+                m_gzip.next_out = reinterpret_cast<unsigned char*>(m_output.data());
+                m_gzip.avail_out = static_cast<uInt>(m_output.size());
+                status = deflate(&m_gzip, last ? Z_FINISH : Z_NO_FLUSH);
+                std::size_t produced = m_output.size() - m_gzip.avail_out;
+                if (std::fwrite(m_output.data(), 1, produced, m_file) != produced) m_ok = false;
+            } while (m_ok && (m_gzip.avail_out == 0 || (last && status != Z_STREAM_END)) && status != Z_STREAM_ERROR);
+            if (status == Z_STREAM_ERROR) m_ok = false;
+        }
+#endif
+            break;
+        case Compression::Zstd:
+#ifdef LEC_HAVE_ZSTD
+        {
+            ZSTD_inBuffer in = {m_buffer.data(), pending, 0};
+            std::size_t remaining;
+            do {
+                ZSTD_outBuffer out = {m_output.data(), m_output.size(), 0};
+                remaining = ZSTD_compressStream2(m_zstd, &out, &in, last ? ZSTD_e_end : ZSTD_e_continue);
+                if (ZSTD_isError(remaining)) {
+                    m_ok = false;
+                    break;
+                }
+                if (std::fwrite(m_output.data(), 1, out.pos, m_file) != out.pos) m_ok = false;
+            } while (m_ok && (last ? remaining != 0 : in.pos < in.size));
+        }
+#endif
+            break;
+        }
+        return m_ok;
+    }
+
+    Compression m_compression = Compression::None;
+    std::FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    std::vector<char> m_output;
+    bool m_ok = true;
+#ifdef LEC_HAVE_ZLIB
+    z_stream m_gzip;
+#endif
+#ifdef LEC_HAVE_ZSTD
+    ZSTD_CCtx* m_zstd = nullptr;
+#endif
+};
+
+CompressingOutputStream::CompressingOutputStream(const std::string& filename)
+    :std::ostream(nullptr), m_streambuf(new CompressingStreambuf(filename)) {
+    rdbuf(m_streambuf.get());
+    if (!m_streambuf->isOpen()) setstate(std::ios::failbit);
+}
+
+CompressingOutputStream::~CompressingOutputStream() {
+    close();
+}
+
+// false if the file could not be opened
+bool CompressingOutputStream::isOpen() const {
+    return m_streambuf->isOpen();
+}
+
+// finishes the compressed stream and closes the file, returns false if something could not be written
+bool CompressingOutputStream::close() {
+    bool ok = m_streambuf->close();
+    if (!ok) setstate(std::ios::badbit);
+    return ok;
+}
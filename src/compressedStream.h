@@ -0,0 +1,103 @@
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// compression formats, detected by the magic bytes of the input files and by the extension of the output files
+enum class Compression { None, Gzip, Zstd };
+
+// function that returns the compression of a file from its first bytes (gzip: 1f 8b, zstd: 28 b5 2f fd)
+Compression detectCompression(const unsigned char* bytes, std::size_t size);
+
+// function that returns the compression of an output file from its extension (.gz or .zst)
+Compression compressionFromExtension(const std::string& filename);
+
+// bounded queue of byte chunks between the thread that reads (and decompresses) a file and the thread that parses it,
+// the producer blocks when the queue is full so the memory used by the pipeline stays bounded
+class ChunkQueue {
+public:
+    explicit ChunkQueue(std::size_t capacity):m_capacity(capacity){}
+
+    // adds a chunk, returns false if the consumer closed the queue
+    bool push(std::string&& chunk);
+    // takes the next chunk, returns false when the producer finished and the queue is empty
+    bool pop(std::string& chunk);
+    // the producer calls it when there are no more chunks (with an error message if it failed)
+    void finish(const std::string& error = "");
+    // the consumer calls it to stop the producer
+    void close();
+    // the error message of the producer, empty if there wasn't an error
+    std::string error();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<std::string> m_chunks;
+    std::size_t m_capacity;
+    bool m_finished = false;
+    bool m_closed = false;
+    std::string m_error;
+};
+
+// input stream of a file that is read and decompressed on its own thread, so the decompression overlaps with the
+// parsing done by the thread that reads the stream, the compression is detected by the magic bytes
+class DecompressingInputStream : public std::istream {
+public:
+    explicit DecompressingInputStream(const std::string& filename);
+    ~DecompressingInputStream();
+
+    // false if the file could not be opened
+    bool isOpen() const { return m_file != nullptr; }
+    // the compression detected in the file
+    Compression compression() const { return m_compression; }
+    // the error of the reading thread (a corrupted file or an unsupported format), empty if there wasn't an error
+    std::string error() { return m_queue.error(); }
+
+private:
+    // streambuf that hands the chunks of the queue to the stream
+    class QueueStreambuf : public std::streambuf {
+    public:
+        explicit QueueStreambuf(ChunkQueue& queue):m_queue(queue){}
+    protected:
+        int_type underflow() override;
+    private:
+        ChunkQueue& m_queue;
+        std::string m_chunk;
+    };
+
+    // body of the reading thread
+    void produce();
+
+    std::FILE* m_file = nullptr;
+    Compression m_compression = Compression::None;
+    ChunkQueue m_queue;
+    QueueStreambuf m_streambuf;
+    std::thread m_thread;
+};
+
+// output stream of a file that is compressed while it is written, the compression is picked by the extension
+class CompressingOutputStream : public std::ostream {
+public:
+    explicit CompressingOutputStream(const std::string& filename);
+    ~CompressingOutputStream();
+
+    // false if the file could not be opened
+    bool isOpen() const;
+    // finishes the compressed stream and closes the file, returns false if something could not be written
+    bool close();
+
+private:
+    class CompressingStreambuf;
+    std::unique_ptr<CompressingStreambuf> m_streambuf;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef COUNTING_TRAITS_H
+#define COUNTING_TRAITS_H
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Interval_nt.h>
+#include <CGAL/Uncertain.h>
+#include <CGAL/predicates/kernel_ftC2.h>
+#include "predicateCounters.h"
+
+// geometric traits of the triangulation, the convex hull and the polygons with LEC_COUNT_PREDICATES: the EPICK kernel
+// with its orientation, in-circle and distance predicates wrapped to count their calls. A call counts as a filter
+// failure when the predicate evaluated with interval arithmetic (the filter EPICK tries before the exact arithmetic)
+// isn't certain, so every call costs one interval evaluation more, but the result is always the one of the kernel
+struct CountingTraits : public CGAL::Exact_predicates_inexact_constructions_kernel {
+    typedef CGAL::Exact_predicates_inexact_constructions_kernel Base;
+    typedef CGAL::Interval_nt<> Interval;
+
+    struct Orientation_2 {
+        typedef CGAL::Orientation result_type;
+        CGAL::Orientation operator()(const Point_2& p, const Point_2& q, const Point_2& r) const {
+            countPredicate(CountedPredicate::Orientation, !CGAL::is_certain(CGAL::orientationC2(Interval(p.x()), Interval(p.y()), Interval(q.x()), Interval(q.y()), Interval(r.x()), Interval(r.y()))));
+            return Base().orientation_2_object()(p, q, r);
+        }
+    };
+
+    // the convex hull asks for left turns, they are orientations
+    struct Left_turn_2 {
+        typedef bool result_type;
+        bool operator()(const Point_2& p, const Point_2& q, const Point_2& r) const {
+            return Orientation_2()(p, q, r) == CGAL::LEFT_TURN;
+        }
+    };
+
+    struct Side_of_oriented_circle_2 {
+        typedef CGAL::Oriented_side result_type;
+        CGAL::Oriented_side operator()(const Point_2& p, const Point_2& q, const Point_2& r, const Point_2& t) const {
+            countPredicate(CountedPredicate::SideOfOrientedCircle, !CGAL::is_certain(CGAL::side_of_oriented_circleC2(Interval(p.x()), Interval(p.y()), Interval(q.x()), Interval(q.y()), Interval(r.x()), Interval(r.y()), Interval(t.x()), Interval(t.y()))));
+            return Base().side_of_oriented_circle_2_object()(p, q, r, t);
+        }
+    };
+
+    struct Compare_distance_2 {
+        typedef CGAL::Comparison_result result_type;
+        CGAL::Comparison_result operator()(const Point_2& p, const Point_2& q, const Point_2& r) const {
+            countPredicate(CountedPredicate::CompareDistance, !CGAL::is_certain(CGAL::compare_distance_to_pointC2(Interval(p.x()), Interval(p.y()), Interval(q.x()), Interval(q.y()), Interval(r.x()), Interval(r.y()))));
+            return Base().compare_distance_2_object()(p, q, r);
+        }
+    };
+
+    Orientation_2 orientation_2_object() const { return Orientation_2(); }
+    Left_turn_2 left_turn_2_object() const { return Left_turn_2(); }
+    Side_of_oriented_circle_2 side_of_oriented_circle_2_object() const { return Side_of_oriented_circle_2(); }
+    Compare_distance_2 compare_distance_2_object() const { return Compare_distance_2(); }
+};
+
+// function that counts the test of the intersection of two segments, which fails its filter if the orientation of an
+// endpoint of a segment with respect to the other one isn't certain in interval arithmetic
+inline void countSegmentIntersection(const CountingTraits::Segment_2& a, const CountingTraits::Segment_2& b) {
+    typedef CountingTraits::Interval Interval;
+    auto isCertain = [](const CountingTraits::Point_2& p, const CountingTraits::Point_2& q, const CountingTraits::Point_2& r) {
+        return CGAL::is_certain(CGAL::orientationC2(Interval(p.x()), Interval(p.y()), Interval(q.x()), Interval(q.y()), Interval(r.x()), Interval(r.y())));
+    };
+    bool certain = isCertain(a.source(), a.target(), b.source()) && isCertain(a.source(), a.target(), b.target()) && isCertain(b.source(), b.target(), a.source()) && isCertain(b.source(), b.target(), a.target());
+    countPredicate(CountedPredicate::SegmentIntersection, !certain);
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "coverageCurve.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// point or vector in doubles, relative to the site of the cell that is being clipped
+struct XY {
+    double x, y;
+};
+
+double cross(const XY& a, const XY& b) { return a.x * b.y - a.y * b.x; }
+double dot(const XY& a, const XY& b) { return a.x * b.x + a.y * b.y; }
+
+// function that keeps the part of the convex polygon where n . p <= c (Sutherland-Hodgman with one half-plane)
+void clipPolygon(std::vector<XY>& polygon, const XY& n, double c) {
+    std::vector<XY> clipped;
+    clipped.reserve(polygon.size() + 1);
+    for (std::size_t i = 0; i < polygon.size(); i++) {
+        const XY& p = polygon[i];
+        const XY& q = polygon[(i + 1) % polygon.size()];
+        double dp = dot(n, p) - c, dq = dot(n, q) - c;
+        if (dp <= 0) clipped.push_back(p);
+        // the edge crosses the line, the crossing is added
+        if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) {
+            double t = dp / (dp - dq);
+            clipped.push_back(XY{p.x + t * (q.x - p.x), p.y + t * (q.y - p.y)});
+        }
+    }
+    polygon.swap(clipped);
+}
+
+// function that returns true if the point is strictly inside the convex polygon (counterclockwise), searching the
+// wedge from the first vertex that holds it
+bool isInsideConvexPolygon(const std::vector<XY>& polygon, const XY& p) {
+    std::size_t m = polygon.size();
+    if (m < 3) return false;
+    XY q{p.x - polygon[0].x, p.y - polygon[0].y};
+    XY first{polygon[1].x - polygon[0].x, polygon[1].y - polygon[0].y};
+    XY last{polygon[m - 1].x - polygon[0].x, polygon[m - 1].y - polygon[0].y};
+    if (cross(first, q) <= 0 || cross(last, q) >= 0) return false;
+    // the last vertex i with the point to the left of the ray from the first vertex to it
+    std::size_t low = 1, high = m - 1;
+    while (high - low > 1) {
+        std::size_t middle = (low + high) / 2;
+        XY v{polygon[middle].x - polygon[0].x, polygon[middle].y - polygon[0].y};
+        if (cross(v, q) > 0) low = middle;
+        else high = middle;
+    }
+    XY edge{polygon[low + 1].x - polygon[low].x, polygon[low + 1].y - polygon[low].y};
+    XY r{p.x - polygon[low].x, p.y - polygon[low].y};
+    return cross(edge, r) > 0;
+}
+
+// function that returns the signed area of the triangle (origin, a, b) inside the disk of radius r around the origin:
+// the pieces of the edge ab inside the disk add triangles and the pieces outside add circular sectors
+double getDiskTriangleArea(const XY& a, const XY& b, double r) {
+    XY d{b.x - a.x, b.y - a.y};
+    double A = dot(d, d), B = 2 * dot(a, d), C = dot(a, a) - r * r;
+    double discriminant = B * B - 4 * A * C;
+    // the edge is split where it crosses the circle
+    XY points[4];
+    std::size_t count = 0;
+    points[count++] = a;
+    if (A > 0 && discriminant > 0) {
+        double root = std::sqrt(discriminant);
+        for (double t : {(-B - root) / (2 * A), (-B + root) / (2 * A)}) {
+            if (t > 0 && t < 1) points[count++] = XY{a.x + t * d.x, a.y + t * d.y};
+        }
+    }
+    points[count++] = b;
+    double area = 0;
+    for (std::size_t i = 0; i + 1 < count; i++) {
+        const XY& p = points[i];
+        const XY& q = points[i + 1];
+        XY middle{(p.x + q.x) / 2, (p.y + q.y) / 2};
+        if (dot(middle, middle) <= r * r) area += cross(p, q) / 2;
+        else area += r * r * std::atan2(cross(p, q), dot(p, q)) / 2;
+    }
+    return area;
+}
+
+// sums of a chunk of cells for every radius: the coefficient of r^2 and the constant areas as differences between
+// consecutive radii, and the areas computed exactly for each radius
+struct CoverageSums {
+    std::vector<double> quadratic;
+    std::vector<double> constant;
+    std::vector<double> exact;
+    double maxDistance = 0;
+};
+
+}
+
+// function that returns the coverage of the convex hull (counterclockwise, like getConvexHull) by the disks around the
+// sites of the triangulation for every radius, the cells are split in chunks solved by threads threads
+CoverageCurve getCoverageCurve(const Delaunay_triangulation_2& dt2, const Polygon_2& ch, std::vector<double> radii, std::size_t threads) {
+    if (dt2.dimension() < 2 || ch.size() < 3) throw std::runtime_error("at least 3 sites not on a line are needed");
+    CoverageCurve curve;
+    std::sort(radii.begin(), radii.end());
+    std::size_t m = radii.size();
+
+    std::vector<XY> hull;
+    for (auto v = ch.vertices_begin(); v != ch.vertices_end(); ++v) hull.push_back(XY{CGAL::to_double(v->x()), CGAL::to_double(v->y())});
+    for (std::size_t i = 0; i < hull.size(); i++) curve.regionArea += cross(hull[i], hull[(i + 1) % hull.size()]) / 2;
+    CGAL::Bbox_2 box = ch.bbox();
+
+    std::vector<Delaunay_triangulation_2::Vertex_handle> sites;
+    sites.reserve(dt2.number_of_vertices());
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) sites.push_back(v);
+
+    std::size_t chunks = (sites.size() + kCandidateChunkSize - 1) / kCandidateChunkSize;
+    std::vector<CoverageSums> chunkSums(chunks);
+    parallelFor(sites.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        CoverageSums& sums = chunkSums[chunk];
+        sums.quadratic.assign(m + 1, 0);
+        sums.constant.assign(m + 1, 0);
+        sums.exact.assign(m, 0);
+        std::vector<XY> cell;
+        for (std::size_t i = begin; i < end; i++) {
+            Delaunay_triangulation_2::Vertex_handle site = sites[i];
+            XY s{CGAL::to_double(site->point().x()), CGAL::to_double(site->point().y())};
+
+            // the cell, relative to its site, is the box of the region cut by the bisector with every neighbor
+            cell = {XY{box.xmin() - s.x, box.ymin() - s.y}, XY{box.xmax() - s.x, box.ymin() - s.y}, XY{box.xmax() - s.x, box.ymax() - s.y}, XY{box.xmin() - s.x, box.ymax() - s.y}};
+            Delaunay_triangulation_2::Vertex_circulator neighbor = dt2.incident_vertices(site), done = neighbor;
+            if (neighbor != nullptr) {
+                do {
+                    if (dt2.is_infinite(neighbor)) continue;
+                    XY w{CGAL::to_double(neighbor->point().x()) - s.x, CGAL::to_double(neighbor->point().y()) - s.y};
+                    clipPolygon(cell, XY{2 * w.x, 2 * w.y}, dot(w, w));
+                } while (++neighbor != done);
+            }
+            // only the cells that go out of the region are cut by its edges, the vertices of the cell are tested against
+            // the region in absolute coordinates (O(log h) each) and the edges of the region are only moved to the site
+            // when the cell is cut
+            bool inside = std::all_of(cell.begin(), cell.end(), [&hull, &s](const XY& p) { return isInsideConvexPolygon(hull, XY{s.x + p.x, s.y + p.y}); });
+            if (!inside) {
+                for (std::size_t j = 0; j < hull.size() && cell.size() >= 3; j++) {
+                    XY h{hull[j].x - s.x, hull[j].y - s.y};
+                    const XY& next = hull[(j + 1) % hull.size()];
+                    XY e{next.x - hull[j].x, next.y - hull[j].y};
+                    clipPolygon(cell, XY{e.y, -e.x}, e.y * h.x - e.x * h.y);
+                }
+            }
+            if (cell.size() < 3) continue;
+
+            // every triangle of the fan from the site adds its area inside the disk to every radius
+            for (std::size_t j = 0; j < cell.size(); j++) {
+                const XY& a = cell[j];
+                const XY& b = cell[(j + 1) % cell.size()];
+                double farthest = std::sqrt(std::max(dot(a, a), dot(b, b)));
+                sums.maxDistance = std::max(sums.maxDistance, farthest);
+                // the distance from the site to the edge, before it the disk only covers a sector of the triangle
+                XY d{b.x - a.x, b.y - a.y};
+                double t = dot(d, d) > 0 ? std::min(1.0, std::max(0.0, -dot(a, d) / dot(d, d))) : 0;
+                XY closest{a.x + t * d.x, a.y + t * d.y};
+                double nearest = std::sqrt(dot(closest, closest));
+                std::size_t lowIndex = std::lower_bound(radii.begin(), radii.end(), nearest) - radii.begin();
+                std::size_t highIndex = std::lower_bound(radii.begin(), radii.end(), farthest) - radii.begin();
+                double halfAngle = std::atan2(cross(a, b), dot(a, b)) / 2;
+                sums.quadratic[0] += halfAngle;
+                sums.quadratic[lowIndex] -= halfAngle;
+                sums.constant[highIndex] += cross(a, b) / 2;
+                for (std::size_t k = lowIndex; k < highIndex; k++) sums.exact[k] += getDiskTriangleArea(a, b, radii[k]);
+            }
+        }
+    });
+
+    // the chunks are added in order, so the curve doesn't depend on the number of threads
+    std::vector<double> quadratic(m + 1, 0), constant(m + 1, 0), exact(m, 0);
+    for (const CoverageSums& sums : chunkSums) {
+        for (std::size_t k = 0; k <= m; k++) {
+            quadratic[k] += sums.quadratic[k];
+            constant[k] += sums.constant[k];
+        }
+        for (std::size_t k = 0; k < m; k++) exact[k] += sums.exact[k];
+        curve.fullCoverageRadius = std::max(curve.fullCoverageRadius, sums.maxDistance);
+    }
+    double quadraticSum = 0, constantSum = 0;
+    for (std::size_t k = 0; k < m; k++) {
+        quadraticSum += quadratic[k];
+        constantSum += constant[k];
+        double covered = quadraticSum * radii[k] * radii[k] + constantSum + exact[k];
+        curve.radii.push_back(radii[k]);
+        curve.coveredFractions.push_back(curve.regionArea > 0 ? std::min(1.0, std::max(0.0, covered / curve.regionArea)) : 0);
+    }
+    return curve;
+}
+
+// function that returns count radii evenly spaced from maxRadius / count to maxRadius
+std::vector<double> getEvenlySpacedRadii(double maxRadius, std::size_t count) {
+    std::vector<double> radii;
+    for (std::size_t i = 1; i <= count; i++) radii.push_back(maxRadius * i / count);
+    return radii;
+}
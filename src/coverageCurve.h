@@ -0,0 +1,32 @@
+#ifndef COVERAGE_CURVE_H
+#define COVERAGE_CURVE_H
+
+#include <cstddef>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// the coverage curve gives, for many radii R, the fraction of the region (the convex hull) that is at most R away from
+// a site, in one pass over the Voronoi cells: every cell is clipped to the region and split in triangles from its site,
+// and the area of a triangle inside the disk of radius r around the site is r^2 times half its angle while the disk
+// doesn't reach its far edge, the whole triangle once the disk passes its farthest vertex, and is only computed exactly
+// for the radii in between, so the triangles are added to all the radii in a single sweep
+
+// coverage of the region for a list of radii
+struct CoverageCurve {
+    // the radii from the smallest to the biggest and the fraction of the region covered by the disks of each radius
+    std::vector<double> radii;
+    std::vector<double> coveredFractions;
+    // the area of the region
+    double regionArea = 0;
+    // the smallest radius that covers the whole region (the radius of the largest empty circle)
+    double fullCoverageRadius = 0;
+};
+
+// function that returns the coverage of the convex hull (counterclockwise, like getConvexHull) by the disks around the
+// sites of the triangulation for every radius, the cells are split in chunks solved by threads threads
+CoverageCurve getCoverageCurve(const Delaunay_triangulation_2& dt2, const Polygon_2& ch, std::vector<double> radii, std::size_t threads = 1);
+
+// function that returns count radii evenly spaced from maxRadius / count to maxRadius
+std::vector<double> getEvenlySpacedRadii(double maxRadius, std::size_t count);
+
+#endif
@@ -0,0 +1,349 @@
+#include "datasetStore.h"
+#include "geojsonReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// number of sites per cell of the grid of hints, so a walk from the hint crosses a few triangles at most
+const std::size_t kSitesPerHint = 16;
+// the grid of hints has at most this many cells on each side
+const std::size_t kMaxHintsPerSide = 1024;
+
+// function that fills the grid of hints of the dataset, the hint of every cell is the site nearest to its center
+void buildHints(Dataset& dataset) {
+    const Delaunay_triangulation_2& dt2 = dataset.stages.dt2;
+    std::vector<Point_2> sites;
+    sites.reserve(dt2.number_of_vertices());
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) sites.push_back(v->point());
+    std::size_t cellsPerSide = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(sites.size()) / kSitesPerHint)));
+    cellsPerSide = std::min(kMaxHintsPerSide, std::max<std::size_t>(1, cellsPerSide));
+    dataset.hintGrid = makeTileGrid(sites, cellsPerSide);
+    dataset.hints.assign(dataset.hintGrid.size(), Delaunay_triangulation_2::Vertex_handle());
+    // the cells are visited row by row and every walk starts from the hint of the previous cell, so they are short
+    Delaunay_triangulation_2::Vertex_handle hint;
+    for (std::size_t cell = 0; cell < dataset.hintGrid.size(); cell++) {
+        Iso_rectangle_2 rectangle = dataset.hintGrid.getTile(cell);
+        Point_2 center = CGAL::midpoint(rectangle.min(), rectangle.max());
+        hint = walkToNearestVertex(dt2, center, hint);
+        dataset.hints[cell] = hint;
+    }
+}
+
+// function that drops what the queries don't need from the stages of the dataset and computes its grid of hints and
+// its memory
+void finishDataset(Dataset& dataset) {
+    // the Voronoi segments are only needed to find the candidates
+    std::list<Segment_2>().swap(dataset.stages.voronoiSegments);
+    buildHints(dataset);
+    dataset.numberOfPoints = dataset.stages.dt2.number_of_vertices();
+    dataset.memoryBytes = estimateStagesBytes(dataset.stages) + dataset.hints.size() * sizeof(Delaunay_triangulation_2::Vertex_handle) + sizeof(Dataset);
+}
+
+}
+
+// function that builds a dataset from points already in memory (at least 3)
+std::shared_ptr<Dataset> makeDataset(const std::string& name, const std::vector<Point_2>& points, std::size_t threads) {
+    if (points.size() < 3) throw std::runtime_error("at least 3 points are needed");
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<Dataset> dataset = std::make_shared<Dataset>();
+    dataset->name = name;
+    LargestEmptyCircleOptions options;
+    options.threads = threads;
+    runLargestEmptyCircleStages(points, dataset->stages, options);
+    // the points repeated in the input are only one site
+    for (auto v = dataset->stages.dt2.finite_vertices_begin(); v != dataset->stages.dt2.finite_vertices_end(); ++v) dataset->contentHash += hashSite(v->point());
+    dataset->nextSiteId = static_cast<SiteId>(points.size());
+    finishDataset(*dataset);
+    dataset->loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return dataset;
+}
+
+// function that builds a dataset from stages that were already run (like the ones read from a snapshot, the convex
+// hull and the best circle are computed again if they are missing), the stages are moved into the dataset
+std::shared_ptr<Dataset> makeDataset(const std::string& name, LargestEmptyCircleStages& stages, std::size_t threads) {
+    if (stages.dt2.number_of_vertices() < 3) throw std::runtime_error("at least 3 points are needed");
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<Dataset> dataset = std::make_shared<Dataset>();
+    dataset->name = name;
+    LargestEmptyCircleStages& moved = dataset->stages;
+    moved.dt2.swap(stages.dt2);
+    moved.bbox = stages.bbox;
+    moved.ch = std::move(stages.ch);
+    moved.chSegments = std::move(stages.chSegments);
+    moved.candidatePoints = std::move(stages.candidatePoints);
+    moved.candidateScores = std::move(stages.candidateScores);
+    moved.circle = stages.circle;
+    moved.topCircles = std::move(stages.topCircles);
+    std::vector<Point_2> sites;
+    sites.reserve(moved.dt2.number_of_vertices());
+    for (auto v = moved.dt2.finite_vertices_begin(); v != moved.dt2.finite_vertices_end(); ++v) {
+        sites.push_back(v->point());
+        dataset->contentHash += hashSite(v->point());
+        dataset->nextSiteId = std::max<SiteId>(dataset->nextSiteId, v->info() + 1);
+    }
+    if (moved.ch.size() < 3) {
+        moved.ch = getConvexHull(sites);
+        moved.chSegments = getPolygonSegments(moved.ch);
+    }
+    if (moved.topCircles.empty()) moved.topCircles = pickLargestEmptyCircles(moved.candidatePoints, moved.candidateScores, 1, threads);
+    finishDataset(*dataset);
+    dataset->loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return dataset;
+}
+
+// function that reads the boundary and the sites of two geojson files and returns them as a dataset ready to be
+// queried, throws std::runtime_error if they can't be read or there are less than 3 points
+std::shared_ptr<Dataset> loadDataset(const std::string& name, const std::string& boundaryFilename, const std::string& sitesFilename, std::size_t threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<Dataset> dataset = makeDataset(name, readInputPoints(boundaryFilename, sitesFilename), threads);
+    dataset->loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return dataset;
+}
+
+// function that returns a copy of the dataset with the sites inserted and removed (a removed point that isn't a site
+// is ignored): the triangulation is copied and updated in place, and the stages after it are run again, so nothing is
+// read or triangulated from scratch, the dataset itself is never changed so the queries that use it don't stop. The copy
+// is the next version of the dataset, null if no site changes (then the current version is kept, nothing is copied)
+std::shared_ptr<Dataset> updateDataset(const Dataset& dataset, const std::vector<Point_2>& inserted, const std::vector<Point_2>& removed, std::size_t threads) {
+    auto start = std::chrono::steady_clock::now();
+    // the points are looked up in the current version first, the triangulation is only copied if some site changes
+    auto isSite = [&dataset](const Point_2& point) { return getNearestSite(dataset, point) == point; };
+    if (std::none_of(removed.begin(), removed.end(), isSite) && std::all_of(inserted.begin(), inserted.end(), isSite)) return nullptr;
+
+    std::shared_ptr<Dataset> updated = std::make_shared<Dataset>();
+    updated->name = dataset.name;
+    updated->version = dataset.version + 1;
+    updated->contentHash = dataset.contentHash;
+    updated->nextSiteId = dataset.nextSiteId;
+    Delaunay_triangulation_2& dt2 = updated->stages.dt2;
+    dt2 = dataset.stages.dt2;
+
+    // the removed sites are found walking from the previous one
+    Delaunay_triangulation_2::Vertex_handle hint;
+    for (const Point_2& point : removed) {
+        Delaunay_triangulation_2::Vertex_handle nearest = walkToNearestVertex(dt2, point, hint);
+        if (nearest->point() != point) continue;
+        // only a point that is a site counts against the 3 sites that must be left
+        if (dt2.number_of_vertices() <= 3) throw std::runtime_error("at least 3 sites must be left");
+        updated->contentHash -= hashSite(point);
+        dt2.remove(nearest);
+        hint = Delaunay_triangulation_2::Vertex_handle();
+    }
+    // a point that is already a site is not inserted again
+    Delaunay_triangulation_2::Face_handle face;
+    for (const Point_2& point : inserted) {
+        std::size_t before = dt2.number_of_vertices();
+        Delaunay_triangulation_2::Vertex_handle v = dt2.insert(point, face);
+        face = v->face();
+        if (dt2.number_of_vertices() == before) continue;
+        v->info() = updated->nextSiteId++;
+        updated->contentHash += hashSite(point);
+    }
+
+    // the stages after the triangulation, with the convex hull and the box of the sites that are left
+    std::vector<Point_2> sites;
+    sites.reserve(dt2.number_of_vertices());
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) sites.push_back(v->point());
+    LargestEmptyCircleStages& stages = updated->stages;
+    stages.bbox = getBoundingBox(sites);
+    stages.voronoiSegments = getCroppedVoronoi(dt2, stages.bbox);
+    stages.ch = getConvexHull(sites);
+    stages.chSegments = getPolygonSegments(stages.ch);
+    LargestEmptyCircleOptions options;
+    options.threads = threads;
+    runCandidateStage(stages, options);
+    runScoreStage(stages, options);
+    finishDataset(*updated);
+    updated->loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return updated;
+}
+
+// function that returns the hash of a site, the content hash of a dataset is the sum of the hashes of its sites
+std::uint64_t hashSite(const Point_2& point) {
+    // the bits of the coordinates mixed by the finalizer of splitmix64
+    double xy[2] = {CGAL::to_double(point.x()), CGAL::to_double(point.y())};
+    std::uint64_t bits[2];
+    std::memcpy(bits, xy, sizeof(bits));
+    std::uint64_t hash = bits[0] * 0x9e3779b97f4a7c15ull ^ bits[1];
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+// function that returns the estimated bytes of memory used by the stages
+std::size_t estimateStagesBytes(const LargestEmptyCircleStages& stages) {
+    // the triangulation keeps its vertices and faces in lists, with two pointers per element
+    std::size_t bytes = (stages.dt2.number_of_vertices() + 1) * (sizeof(Delaunay_triangulation_2::Vertex) + 2 * sizeof(void*));
+    bytes += (stages.dt2.number_of_faces() + stages.dt2.number_of_vertices()) * (sizeof(Delaunay_triangulation_2::Face) + 2 * sizeof(void*));
+    bytes += stages.voronoiSegments.size() * (sizeof(Segment_2) + 2 * sizeof(void*));
+    bytes += stages.ch.size() * sizeof(Point_2) + stages.chSegments.size() * sizeof(Segment_2);
+    bytes += stages.candidatePoints.capacity() * sizeof(Point_2) + stages.candidateScores.capacity() * sizeof(K::FT);
+    bytes += stages.topCircles.capacity() * sizeof(LargestEmptyCircle);
+    return bytes;
+}
+
+// function that returns the vertex of the site nearest to the point, walking from the site of the cell of the grid of
+// the point
+Delaunay_triangulation_2::Vertex_handle getNearestVertex(const Dataset& dataset, const Point_2& point) {
+    Delaunay_triangulation_2::Vertex_handle hint = dataset.hints[dataset.hintGrid.getTileIndex(point)];
+    return walkToNearestVertex(dataset.stages.dt2, point, hint);
+}
+
+// function that returns the site nearest to the point
+Point_2 getNearestSite(const Dataset& dataset, const Point_2& point) {
+    return getNearestVertex(dataset, point)->point();
+}
+
+// function that returns the k largest empty circles of the dataset from its stored scores
+std::vector<LargestEmptyCircle> getTopCircles(const Dataset& dataset, std::size_t k, std::size_t threads) {
+    if (k <= dataset.stages.topCircles.size()) {
+        return std::vector<LargestEmptyCircle>(dataset.stages.topCircles.begin(), dataset.stages.topCircles.begin() + k);
+    }
+    return pickLargestEmptyCircles(dataset.stages.candidatePoints, dataset.stages.candidateScores, k, threads);
+}
+
+// constructor with the memory budget in bytes, starts the thread that destroys the old versions
+DatasetStore::DatasetStore(std::size_t memoryBudget) : m_slots(new SlotMap()), m_memoryBudget(memoryBudget) {
+    m_reclaimer = std::thread(&DatasetStore::reclaim, this);
+}
+
+// stops the thread that destroys the old versions
+DatasetStore::~DatasetStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_reclaimerMutex);
+        m_stopping = true;
+    }
+    m_reclaimerWakeUp.notify_one();
+    m_reclaimer.join();
+    // no query is running anymore, the last versions are retired with the map and destroyed by the reclamation
+    const SlotMap* slots = m_slots.load();
+    for (const auto& slot : *slots) replaceVersion(*slot.second);
+    delete slots;
+}
+
+// body of the thread that destroys the old versions, it runs after every write and every some milliseconds, for the
+// versions that were still pinned by a query the last time
+void DatasetStore::reclaim() {
+    std::unique_lock<std::mutex> lock(m_reclaimerMutex);
+    while (!m_stopping) {
+        m_reclaimerWakeUp.wait_for(lock, std::chrono::milliseconds(100));
+        lock.unlock();
+        m_reclamation.collect();
+        lock.lock();
+    }
+}
+
+// publishes the map of names (already changed by a writer) and retires the previous one
+void DatasetStore::publishSlots(SlotMap* slots) {
+    const SlotMap* previous = m_slots.exchange(slots);
+    m_reclamation.retire([previous]() { delete previous; });
+}
+
+// replaces the version of the slot with the next one (null drops it) and retires the previous one, so it's destroyed
+// when no query uses it
+void DatasetStore::replaceVersion(Slot& slot, const std::shared_ptr<const Dataset>* next) {
+    if (next != nullptr) m_memoryUsed += (*next)->memoryBytes;
+    const std::shared_ptr<const Dataset>* previous = slot.current.exchange(next);
+    if (previous == nullptr) return;
+    m_memoryUsed -= (*previous)->memoryBytes;
+    m_reclamation.retire([previous]() { delete previous; });
+}
+
+// publishes the dataset as the current version of its name (the previous one is retired) and as the most recently
+// used one, and drops the least recently used ones until the memory is under the budget (the new one is always kept)
+void DatasetStore::add(std::shared_ptr<const Dataset> dataset) {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        const SlotMap* slots = m_slots.load();
+        std::int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        auto slot = slots->find(dataset->name);
+        if (slot == slots->end()) {
+            // a new name is added to a copy of the map, the queries keep reading the previous one meanwhile
+            SlotMap* copy = new SlotMap(*slots);
+            std::shared_ptr<Slot> added = std::make_shared<Slot>();
+            replaceVersion(*added, new std::shared_ptr<const Dataset>(dataset));
+            added->lastUsed.store(now);
+            (*copy)[dataset->name] = added;
+            publishSlots(copy);
+        } else {
+            // the next version of a name only replaces the version of its slot
+            replaceVersion(*slot->second, new std::shared_ptr<const Dataset>(dataset));
+            slot->second->lastUsed.store(now);
+        }
+
+        // the least recently used datasets are dropped from one copy of the map
+        SlotMap* evicted = nullptr;
+        while (m_memoryUsed.load() > m_memoryBudget) {
+            const SlotMap& current = evicted != nullptr ? *evicted : *m_slots.load();
+            auto oldest = current.end();
+            for (auto candidate = current.begin(); candidate != current.end(); ++candidate) {
+                if (candidate->first == dataset->name) continue;
+                if (oldest == current.end() || candidate->second->lastUsed.load() < oldest->second->lastUsed.load()) oldest = candidate;
+            }
+            if (oldest == current.end()) break;
+            if (evicted == nullptr) {
+                evicted = new SlotMap(current);
+                oldest = evicted->find(oldest->first);
+            }
+            replaceVersion(*oldest->second);
+            evicted->erase(oldest);
+            m_evictions++;
+        }
+        if (evicted != nullptr) publishSlots(evicted);
+    }
+    m_reclaimerWakeUp.notify_one();
+}
+
+// pins the current version of the dataset and marks it as the most recently used one, without locks
+DatasetStore::Pin DatasetStore::get(const std::string& name) {
+    EpochReclamation::Guard guard = m_reclamation.pin();
+    const SlotMap* slots = m_slots.load();
+    auto slot = slots->find(name);
+    if (slot == slots->end()) return Pin(std::move(guard), nullptr);
+    const std::shared_ptr<const Dataset>* current = slot->second->current.load();
+    if (current == nullptr) return Pin(std::move(guard), nullptr);
+    // the time is only written when it changes, so the queries of a dataset rarely write the same cache line
+    std::int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (slot->second->lastUsed.load(std::memory_order_relaxed) != now) slot->second->lastUsed.store(now, std::memory_order_relaxed);
+    return Pin(std::move(guard), current->get());
+}
+
+// drops the dataset, returns false if it wasn't in the store
+bool DatasetStore::remove(const std::string& name) {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        const SlotMap* slots = m_slots.load();
+        auto slot = slots->find(name);
+        if (slot == slots->end()) return false;
+        replaceVersion(*slot->second);
+        SlotMap* copy = new SlotMap(*slots);
+        copy->erase(name);
+        publishSlots(copy);
+    }
+    m_reclaimerWakeUp.notify_one();
+    return true;
+}
+
+// the datasets from the most recently used to the least recently used
+std::vector<DatasetStore::DatasetInfo> DatasetStore::list() {
+    EpochReclamation::Guard guard = m_reclamation.pin();
+    std::vector<std::pair<std::int64_t, DatasetInfo>> datasets;
+    for (const auto& slot : *m_slots.load()) {
+        const std::shared_ptr<const Dataset>* current = slot.second->current.load();
+        if (current == nullptr) continue;
+        DatasetInfo info;
+        info.name = (*current)->name;
+        info.version = (*current)->version;
+        info.numberOfPoints = (*current)->numberOfPoints;
+        info.memoryBytes = (*current)->memoryBytes;
+        datasets.emplace_back(slot.second->lastUsed.load(std::memory_order_relaxed), info);
+    }
+    std::stable_sort(datasets.begin(), datasets.end(), [](const std::pair<std::int64_t, DatasetInfo>& a, const std::pair<std::int64_t, DatasetInfo>& b) { return a.first > b.first; });
+    std::vector<DatasetInfo> infos;
+    for (const auto& dataset : datasets) infos.push_back(dataset.second);
+    return infos;
+}
@@ -0,0 +1,165 @@
+#ifndef DATASET_STORE_H
+#define DATASET_STORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "epochReclamation.h"
+#include "largestEmptyCircle.h"
+#include "tiledLargestEmptyCircle.h"
+
+// dataset kept in memory by the query server: the output of the stages of its points plus a grid with a site near
+// every cell, the start of the walks of the nearest site queries, it's never changed after it's loaded so many
+// threads can query it at the same time (an update makes a new version)
+struct Dataset {
+    std::string name;
+    // 1 when it's loaded, every update adds 1
+    std::uint64_t version = 1;
+    std::size_t numberOfPoints = 0;
+    // hash of the content of the dataset, the sum of the hashes of its sites so an update changes it without hashing
+    // the other sites, and the id of the next inserted site
+    std::uint64_t contentHash = 0;
+    SiteId nextSiteId = 0;
+    // the stages without the Voronoi segments, the queries don't need them
+    LargestEmptyCircleStages stages;
+    // grid over the bounding box of the sites and the site nearest to the center of every cell
+    TileGrid hintGrid;
+    std::vector<Delaunay_triangulation_2::Vertex_handle> hints;
+    // estimated bytes of memory used by the dataset
+    std::size_t memoryBytes = 0;
+    // time spent reading and triangulating the points
+    double loadSeconds = 0;
+};
+
+// function that reads the boundary and the sites of two geojson files and returns them as a dataset ready to be
+// queried, throws std::runtime_error if they can't be read or there are less than 3 points
+std::shared_ptr<Dataset> loadDataset(const std::string& name, const std::string& boundaryFilename, const std::string& sitesFilename, std::size_t threads = 1);
+
+// function that builds a dataset from points already in memory (at least 3)
+std::shared_ptr<Dataset> makeDataset(const std::string& name, const std::vector<Point_2>& points, std::size_t threads = 1);
+
+// function that builds a dataset from stages that were already run (like the ones read from a snapshot, the convex
+// hull and the best circle are computed again if they are missing), the stages are moved into the dataset
+std::shared_ptr<Dataset> makeDataset(const std::string& name, LargestEmptyCircleStages& stages, std::size_t threads = 1);
+
+// function that returns a copy of the dataset with the sites inserted and removed (a removed point that isn't a site
+// is ignored): the triangulation is copied and updated in place, and the stages after it are run again, so nothing is
+// read or triangulated from scratch, the dataset itself is never changed so the queries that use it don't stop. The copy
+// is the next version of the dataset, null if no site changes (then the current version is kept, nothing is copied)
+std::shared_ptr<Dataset> updateDataset(const Dataset& dataset, const std::vector<Point_2>& inserted, const std::vector<Point_2>& removed, std::size_t threads = 1);
+
+// function that returns the hash of a site, the content hash of a dataset is the sum of the hashes of its sites
+std::uint64_t hashSite(const Point_2& point);
+
+// function that returns the estimated bytes of memory used by the stages
+std::size_t estimateStagesBytes(const LargestEmptyCircleStages& stages);
+
+// function that returns the vertex of the site nearest to the point, walking from the site of the cell of the grid of
+// the point
+Delaunay_triangulation_2::Vertex_handle getNearestVertex(const Dataset& dataset, const Point_2& point);
+
+// function that returns the site nearest to the point
+Point_2 getNearestSite(const Dataset& dataset, const Point_2& point);
+
+// function that returns the k largest empty circles of the dataset from its stored scores
+std::vector<LargestEmptyCircle> getTopCircles(const Dataset& dataset, std::size_t k, std::size_t threads = 1);
+
+// datasets kept in memory by name, when their estimated memory goes over the budget the least recently used ones are
+// dropped. Every dataset is an immutable version: an update builds the next version apart and publishes it with one
+// atomic store, and the queries read the names and the versions without locks, pinning them with epoch based
+// reclamation, so a query keeps the version it started with (even if it's replaced or dropped meanwhile) and never
+// waits for an update. The versions nobody can read anymore are destroyed by a thread of the store, not by the queries
+class DatasetStore {
+public:
+    // summary of a dataset of the store
+    struct DatasetInfo {
+        std::string name;
+        std::uint64_t version = 0;
+        std::size_t numberOfPoints = 0;
+        std::size_t memoryBytes = 0;
+    };
+
+    // version of a dataset pinned by a query until it's destroyed, empty if the dataset is not in the store
+    class Pin {
+    public:
+        const Dataset* get() const { return m_dataset; }
+        const Dataset& operator*() const { return *m_dataset; }
+        const Dataset* operator->() const { return m_dataset; }
+        explicit operator bool() const { return m_dataset != nullptr; }
+
+    private:
+        friend class DatasetStore;
+        Pin(EpochReclamation::Guard guard, const Dataset* dataset) : m_guard(std::move(guard)), m_dataset(dataset) {}
+        EpochReclamation::Guard m_guard;
+        const Dataset* m_dataset;
+    };
+
+    // constructor with the memory budget in bytes, starts the thread that destroys the old versions
+    explicit DatasetStore(std::size_t memoryBudget);
+
+    DatasetStore(const DatasetStore&) = delete;
+    DatasetStore& operator=(const DatasetStore&) = delete;
+
+    // stops the thread that destroys the old versions
+    ~DatasetStore();
+
+    // publishes the dataset as the current version of its name (the previous one is retired) and as the most recently
+    // used one, and drops the least recently used ones until the memory is under the budget (the new one is always kept)
+    void add(std::shared_ptr<const Dataset> dataset);
+
+    // pins the current version of the dataset and marks it as the most recently used one, without locks
+    Pin get(const std::string& name);
+
+    // drops the dataset, returns false if it wasn't in the store
+    bool remove(const std::string& name);
+
+    // the datasets from the most recently used to the least recently used
+    std::vector<DatasetInfo> list();
+
+    std::size_t memoryBudget() const { return m_memoryBudget; }
+    std::size_t memoryUsed() const { return m_memoryUsed.load(std::memory_order_relaxed); }
+    // number of datasets dropped to stay under the budget
+    std::size_t evictions() const { return m_evictions.load(std::memory_order_relaxed); }
+    // number of replaced or dropped versions not destroyed yet (some query may still use them)
+    std::size_t retiredVersions() const { return m_reclamation.pending(); }
+
+private:
+    // the place of a name, its current version is replaced by the updates
+    struct Slot {
+        std::atomic<const std::shared_ptr<const Dataset>*> current{nullptr};
+        // the last time it was read in milliseconds, for the least recently used order
+        std::atomic<std::int64_t> lastUsed{0};
+    };
+    typedef std::unordered_map<std::string, std::shared_ptr<Slot>> SlotMap;
+
+    // publishes the map of names (already changed by a writer) and retires the previous one
+    void publishSlots(SlotMap* slots);
+    // replaces the version of the slot with the next one (null drops it) and retires the previous one, so it's
+    // destroyed when no query uses it
+    void replaceVersion(Slot& slot, const std::shared_ptr<const Dataset>* next = nullptr);
+    // body of the thread that destroys the old versions
+    void reclaim();
+
+    EpochReclamation m_reclamation;
+    // the names, replaced as a whole when one is added or dropped
+    std::atomic<const SlotMap*> m_slots;
+    // the writers (add and remove) are made one at a time
+    std::mutex m_writeMutex;
+    std::size_t m_memoryBudget;
+    std::atomic<std::size_t> m_memoryUsed{0};
+    std::atomic<std::size_t> m_evictions{0};
+    // the thread that destroys the old versions, woken up by the writers
+    std::thread m_reclaimer;
+    std::mutex m_reclaimerMutex;
+    std::condition_variable m_reclaimerWakeUp;
+    bool m_stopping = false;
+};
+
+#endif
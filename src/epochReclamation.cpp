@@ -0,0 +1,74 @@
+#include "epochReclamation.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+// constructor with the most readers that can be pinned at the same time (pin() waits for a free slot)
+EpochReclamation::EpochReclamation(std::size_t maxReaders) : m_maxReaders(maxReaders == 0 ? 1 : maxReaders), m_readers(new Reader[m_maxReaders]) {}
+
+// destroys the retired objects, no reader can be pinned anymore
+EpochReclamation::~EpochReclamation() {
+    for (auto& retired : m_retired) retired.second();
+}
+
+EpochReclamation::Guard::~Guard() {
+    if (m_reader == nullptr) return;
+    m_reader->epoch.store(0, std::memory_order_release);
+    m_reader->taken.store(false, std::memory_order_release);
+}
+
+// pins the current epoch, the objects read from now on are not destroyed until the guard is
+EpochReclamation::Guard EpochReclamation::pin() {
+    // every thread starts looking for a free slot in a different place, so they rarely try the same one
+    std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % m_maxReaders;
+    for (std::size_t attempt = 0;; attempt++) {
+        Reader& reader = m_readers[(start + attempt) % m_maxReaders];
+        bool taken = false;
+        if (!reader.taken.load(std::memory_order_relaxed) && reader.taken.compare_exchange_strong(taken, true, std::memory_order_acquire)) {
+            // the epoch is published before any object is read, so a writer that retires an object after this reader
+            // read the epoch sees the reader pinned: the fence keeps the loads of the caller (which can be only acquire)
+            // from being done before the store of the epoch
+            reader.epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return Guard(&reader);
+        }
+        if (attempt > 0 && attempt % m_maxReaders == 0) std::this_thread::yield();
+    }
+}
+
+// retires an object that is no longer reachable by new readers, the deleter destroys it once the readers that could
+// have seen it are gone
+void EpochReclamation::retire(std::function<void()> deleter) {
+    // the object was unlinked before the epoch advances, so the readers that pin the next epoch can't see it
+    std::uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(m_retiredMutex);
+    m_retired.emplace_back(epoch, std::move(deleter));
+}
+
+// runs the deleters of the objects no reader can see anymore, returns how many were run
+std::size_t EpochReclamation::collect() {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+        if (m_retired.empty()) return 0;
+        // the oldest epoch still pinned, an object retired before it is not seen by anyone
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t i = 0; i < m_maxReaders; i++) {
+            std::uint64_t epoch = m_readers[i].epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0) oldest = std::min(oldest, epoch);
+        }
+        auto kept = std::stable_partition(m_retired.begin(), m_retired.end(), [oldest](const std::pair<std::uint64_t, std::function<void()>>& retired) { return retired.first >= oldest; });
+        for (auto retired = kept; retired != m_retired.end(); ++retired) ready.push_back(std::move(retired->second));
+        m_retired.erase(kept, m_retired.end());
+    }
+    // the objects are destroyed without the lock, so retire() doesn't wait for them
+    for (std::function<void()>& deleter : ready) deleter();
+    return ready.size();
+}
+
+// the number of retired objects not destroyed yet
+std::size_t EpochReclamation::pending() const {
+    std::lock_guard<std::mutex> lock(m_retiredMutex);
+    return m_retired.size();
+}
@@ -0,0 +1,79 @@
+#ifndef EPOCH_RECLAMATION_H
+#define EPOCH_RECLAMATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// epoch based reclamation of objects shared by readers that never lock: a reader pins the current epoch in a slot of
+// its own while it uses the objects, and a writer that unlinks an object retires it with the epoch it was unlinked in,
+// then the object is destroyed by collect() once no reader is pinned to that epoch or an older one (the readers
+// pinned later can't have seen it). The readers only write their own slot, so they never wait for a writer or for the
+// destruction of what they stopped using
+class EpochReclamation {
+    struct Reader;
+
+public:
+    // constructor with the most readers that can be pinned at the same time (pin() waits for a free slot)
+    explicit EpochReclamation(std::size_t maxReaders = 1024);
+
+    EpochReclamation(const EpochReclamation&) = delete;
+    EpochReclamation& operator=(const EpochReclamation&) = delete;
+
+    // destroys the retired objects, no reader can be pinned anymore
+    ~EpochReclamation();
+
+    // epoch pinned by a reader until the guard is destroyed
+    class Guard {
+    public:
+        Guard(Guard&& other) noexcept : m_reader(other.m_reader) { other.m_reader = nullptr; }
+        Guard& operator=(Guard&& other) noexcept {
+            std::swap(m_reader, other.m_reader);
+            return *this;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard();
+
+    private:
+        friend class EpochReclamation;
+        explicit Guard(Reader* reader) : m_reader(reader) {}
+        // the slot of the reader, null if the guard was moved
+        Reader* m_reader;
+    };
+
+    // pins the current epoch, the objects read from now on are not destroyed until the guard is
+    Guard pin();
+
+    // retires an object that is no longer reachable by new readers, the deleter destroys it once the readers that could
+    // have seen it are gone
+    void retire(std::function<void()> deleter);
+
+    // runs the deleters of the objects no reader can see anymore, returns how many were run
+    std::size_t collect();
+
+    // the number of retired objects not destroyed yet
+    std::size_t pending() const;
+
+private:
+    // slot of a reader, each one in its own cache line so the readers don't slow each other down
+    struct alignas(64) Reader {
+        // the pinned epoch, 0 when the reader isn't pinned
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> taken{false};
+    };
+
+    std::atomic<std::uint64_t> m_epoch{1};
+    std::size_t m_maxReaders;
+    std::unique_ptr<Reader[]> m_readers;
+    // the deleters with the epoch their objects were unlinked in
+    mutable std::mutex m_retiredMutex;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> m_retired;
+};
+
+#endif
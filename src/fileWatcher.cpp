@@ -0,0 +1,72 @@
+#include "fileWatcher.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// constructor that starts the thread of the watcher, a change is reported once the file had no events for
+// quietTime, throws std::runtime_error if inotify can't be used
+FileWatcher::FileWatcher(Callback callback, std::chrono::milliseconds quietTime) : m_callback(std::move(callback)), m_quietTime(quietTime) {
+    m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) throw std::runtime_error(std::string("could not start inotify: ") + std::strerror(errno));
+    m_thread = std::thread(&FileWatcher::run, this);
+}
+
+// stops the thread of the watcher
+FileWatcher::~FileWatcher() {
+    m_stopping = true;
+    m_thread.join();
+    ::close(m_inotify);
+}
+
+// starts watching the file (it must be in a directory that exists), throws std::runtime_error if it can't
+void FileWatcher::watch(const std::string& filename) {
+    std::filesystem::path path = std::filesystem::absolute(filename).lexically_normal();
+    std::string directory = path.parent_path().string();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // watching a directory twice returns the same descriptor
+    int descriptor = ::inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0) throw std::runtime_error("could not watch " + directory + ": " + std::strerror(errno));
+    m_directories[descriptor] = directory;
+    m_files[path.string()] = filename;
+}
+
+// body of the thread of the watcher
+void FileWatcher::run() {
+    // the files that changed and when they had their last event
+    std::map<std::string, std::chrono::steady_clock::time_point> changed;
+    std::vector<char> buffer(64 * 1024);
+    while (!m_stopping) {
+        // the poll wakes up often enough to see m_stopping and to report the files that became quiet
+        pollfd descriptor{m_inotify, POLLIN, 0};
+        int ready = ::poll(&descriptor, 1, 50);
+        if (ready > 0) {
+            ssize_t length;
+            while ((length = ::read(m_inotify, buffer.data(), buffer.size())) > 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (ssize_t offset = 0; offset < length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                    offset += sizeof(inotify_event) + event->len;
+                    auto directory = m_directories.find(event->wd);
+                    if (directory == m_directories.end() || event->len == 0) continue;
+                    auto file = m_files.find(directory->second + "/" + event->name);
+                    if (file != m_files.end()) changed[file->second] = std::chrono::steady_clock::now();
+                }
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        for (auto file = changed.begin(); file != changed.end();) {
+            if (now - file->second < m_quietTime) {
+                ++file;
+                continue;
+            }
+            std::string filename = file->first;
+            file = changed.erase(file);
+            m_callback(filename);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+// watches files with inotify and calls a callback (on its own thread) with the name of a file some time after it
+// stops changing, so a file that is rewritten in many writes is reported once. The directories of the files are
+// watched instead of the files, so a file that is replaced by renaming a new one over it (like most extracts and
+// editors do) is still followed
+class FileWatcher {
+public:
+    // function called with the name of a watched file (as it was given to watch()) when it changed, it must not throw
+    typedef std::function<void(const std::string&)> Callback;
+
+    // constructor that starts the thread of the watcher, a change is reported once the file had no events for
+    // quietTime, throws std::runtime_error if inotify can't be used
+    explicit FileWatcher(Callback callback, std::chrono::milliseconds quietTime = std::chrono::milliseconds(200));
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // stops the thread of the watcher
+    ~FileWatcher();
+
+    // starts watching the file (it must be in a directory that exists), throws std::runtime_error if it can't
+    void watch(const std::string& filename);
+
+private:
+    // body of the thread of the watcher
+    void run();
+
+    Callback m_callback;
+    std::chrono::milliseconds m_quietTime;
+    int m_inotify = -1;
+    std::mutex m_mutex;
+    // the watched directories by their inotify descriptor and the watched files by their full name
+    std::map<int, std::string> m_directories;
+    std::map<std::string, std::string> m_files;
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+};
+
+#endif
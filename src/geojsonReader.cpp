@@ -0,0 +1,184 @@
+#include "geojsonReader.h"
+#include "compressedStream.h"
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+using json = nlohmann::json;
+
+// SAX handler that follows the path of the values inside the document and collects the geometry of every feature,
+// a feature is handed to the callback when its object ends
+class GeojsonSaxHandler : public nlohmann::json_sax<json> {
+public:
+    explicit GeojsonSaxHandler(const std::function<void(const GeojsonFeature&)>& callback):m_callback(callback){}
+
+    bool null() override { return afterValue(); }
+    bool boolean(bool) override { return afterValue(); }
+    bool number_integer(number_integer_t value) override { return number(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return number(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return number(value); }
+    bool binary(binary_t&) override { return afterValue(); }
+
+    bool string(string_t& value) override {
+        // the "type" of the "geometry" of a feature
+        if (inGeometry() && m_stack.size() == 4 && m_stack[3].key == "type") m_feature.geometryType = value;
+        // the "@id" of the "properties" of a feature
+        if (inProperties() && m_stack.size() == 4 && m_stack[3].key == "@id") m_feature.id = value;
+        return afterValue();
+    }
+
+    bool start_object(std::size_t) override {
+        // an object inside the "features" array is a new feature
+        if (inFeatures() && m_stack.size() == 2) {
+            m_feature.index = m_stack[1].index;
+            m_feature.id.clear();
+            m_feature.geometryType.clear();
+            m_feature.coordinates.clear();
+        }
+        m_stack.push_back(Frame{false, std::string(), 0});
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        m_stack.back().key = value;
+        return true;
+    }
+
+    bool end_object() override {
+        m_stack.pop_back();
+        // the feature is complete
+        if (inFeatures() && m_stack.size() == 2) m_callback(m_feature);
+        return afterValue();
+    }
+
+    bool start_array(std::size_t) override {
+        m_stack.push_back(Frame{true, std::string(), 0});
+        return true;
+    }
+
+    bool end_array() override {
+        m_stack.pop_back();
+        return afterValue();
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& exception) override {
+        m_error = "parse error at byte " + std::to_string(position) + ": " + exception.what();
+        return false;
+    }
+
+    const std::string& error() const { return m_error; }
+
+private:
+    // an open object or array, with the key of the current member or the index of the current element
+    struct Frame {
+        bool isArray;
+        std::string key;
+        std::size_t index;
+    };
+
+    // true if the current value is inside the "features" array of the root object
+    bool inFeatures() const {
+        return m_stack.size() >= 2 && m_stack[0].key == "features" && m_stack[1].isArray;
+    }
+
+    // true if the current value is inside the "geometry" object of a feature
+    bool inGeometry() const {
+        return inFeatures() && m_stack.size() >= 4 && !m_stack[2].isArray && m_stack[2].key == "geometry" && !m_stack[3].isArray;
+    }
+
+    // true if the current value is inside the "properties" object of a feature
+    bool inProperties() const {
+        return inFeatures() && m_stack.size() >= 4 && !m_stack[2].isArray && m_stack[2].key == "properties" && !m_stack[3].isArray;
+    }
+
+    // a coordinate is kept if it is the x or y of a Point ([x, y]) or of the first ring of a Polygon ([[[x, y], ...]])
+    bool number(double value) {
+        if (inGeometry() && m_stack[3].key == "coordinates") {
+            std::size_t depth = m_stack.size() - 4;
+            bool isAxis = m_stack.back().index < 2;
+            if ((depth == 1 && isAxis) || (depth == 3 && m_stack[4].index == 0 && isAxis)) m_feature.coordinates.push_back(value);
+        }
+        return afterValue();
+    }
+
+    // moves to the next element once a value inside an array is complete
+    bool afterValue() {
+        if (!m_stack.empty() && m_stack.back().isArray) m_stack.back().index++;
+        return true;
+    }
+
+    const std::function<void(const GeojsonFeature&)>& m_callback;
+    std::vector<Frame> m_stack;
+    GeojsonFeature m_feature;
+    std::string m_error;
+};
+
+}
+
+// function that parses a GeoJSON FeatureCollection with a SAX parser and calls the callback once per feature, without
+// building the whole document in memory, the file may be compressed with gzip or zstd (detected by its magic bytes)
+// and it is read and decompressed on another thread while it is parsed, throws std::runtime_error if it can't be read
+void readGeojsonFeatures(const std::string& filename, const std::function<void(const GeojsonFeature&)>& callback) {
+    DecompressingInputStream file(filename);
+    if (!file.isOpen()) throw std::runtime_error("could not open " + filename);
+    GeojsonSaxHandler handler(callback);
+    bool parsed = json::sax_parse(file, &handler);
+    // an error of the reading thread explains a parse error, so it is reported first
+    std::string error = file.error();
+    if (!error.empty()) throw std::runtime_error(filename + ": " + error);
+    if (!parsed) throw std::runtime_error(filename + ": " + handler.error());
+}
+
+// function that calls the callback with every vertex of the first ring of the first feature of a geojson file
+// (the boundary), without storing them
+void forEachBoundaryPoint(const std::string& filename, const std::function<void(const Point_2&)>& callback) {
+    readGeojsonFeatures(filename, [&callback](const GeojsonFeature& feature) {
+        if (feature.index != 0) return;
+        // for all coordinates in the ring
+        for (std::size_t i = 0; i + 1 < feature.coordinates.size(); i += 2) {
+            // the x and y coordinates are extracted
+            float x = feature.coordinates[i];
+            float y = feature.coordinates[i + 1];
+            // the position is given to the callback
+            callback(Point_2(x, y));
+        }
+    });
+}
+
+// function that calls the callback with every Point feature of a geojson file (the sites inside the boundary),
+// without storing them
+void forEachSitePoint(const std::string& filename, const std::function<void(const Point_2&)>& callback) {
+    readGeojsonFeatures(filename, [&callback](const GeojsonFeature& feature) {
+        // if the geometry is a "Point", the coordinates are extracted ("Polygon" features are skipped)
+        if (feature.geometryType != "Point" || feature.coordinates.size() < 2) return;
+        float x = feature.coordinates[0];
+        float y = feature.coordinates[1];
+        // the position is given to the callback
+        callback(Point_2(x, y));
+    });
+}
+
+// function that adds the vertices of the first ring of the first feature of a geojson file (the boundary) to points
+void readBoundaryPoints(const std::string& filename, std::vector<Point_2>& points) {
+    forEachBoundaryPoint(filename, [&points](const Point_2& point) { points.push_back(point); });
+}
+
+// function that adds the Point features of a geojson file (the sites inside the boundary) to points
+void readSitePoints(const std::string& filename, std::vector<Point_2>& points) {
+    forEachSitePoint(filename, [&points](const Point_2& point) { points.push_back(point); });
+}
+
+// function that calls the callback with the boundary and then the sites inside it from two geojson files
+void forEachInputPoint(const std::string& boundaryFilename, const std::string& sitesFilename, const std::function<void(const Point_2&)>& callback) {
+    forEachBoundaryPoint(boundaryFilename, callback);
+    forEachSitePoint(sitesFilename, callback);
+}
+
+// function that reads the boundary and the sites inside it from two geojson files and returns all the points
+std::vector<Point_2> readInputPoints(const std::string& boundaryFilename, const std::string& sitesFilename) {
+    std::vector<Point_2> points;
+    readBoundaryPoints(boundaryFilename, points);
+    readSitePoints(sitesFilename, points);
+    return points;
+}
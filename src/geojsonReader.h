@@ -0,0 +1,46 @@
+#ifndef GEOJSON_READER_H
+#define GEOJSON_READER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// feature of a GeoJSON FeatureCollection, only with what the engine needs
+struct GeojsonFeature {
+    // position of the feature in the collection
+    std::size_t index = 0;
+    // the "@id" property (the OpenStreetMap id of the exports of overpass, like "node/123"), empty if it has none
+    std::string id;
+    // the type of the geometry ("Point", "Polygon", ...)
+    std::string geometryType;
+    // for a Point the x and y coordinates, for a Polygon the x, y pairs of its first (outer) ring
+    std::vector<double> coordinates;
+};
+
+// function that parses a GeoJSON FeatureCollection with a SAX parser and calls the callback once per feature, without
+// building the whole document in memory, the file may be compressed with gzip or zstd (detected by its magic bytes)
+// and it is read and decompressed on another thread while it is parsed, throws std::runtime_error if it can't be read
+void readGeojsonFeatures(const std::string& filename, const std::function<void(const GeojsonFeature&)>& callback);
+
+// function that calls the callback with every vertex of the first ring of the first feature of a geojson file
+// (the boundary), without storing them
+void forEachBoundaryPoint(const std::string& filename, const std::function<void(const Point_2&)>& callback);
+
+// function that calls the callback with every Point feature of a geojson file (the sites inside the boundary),
+// without storing them
+void forEachSitePoint(const std::string& filename, const std::function<void(const Point_2&)>& callback);
+
+// function that adds the vertices of the first ring of the first feature of a geojson file (the boundary) to points
+void readBoundaryPoints(const std::string& filename, std::vector<Point_2>& points);
+
+// function that adds the Point features of a geojson file (the sites inside the boundary) to points
+void readSitePoints(const std::string& filename, std::vector<Point_2>& points);
+
+// function that calls the callback with the boundary and then the sites inside it from two geojson files
+void forEachInputPoint(const std::string& boundaryFilename, const std::string& sitesFilename, const std::function<void(const Point_2&)>& callback);
+
+// function that reads the boundary and the sites inside it from two geojson files and returns all the points
+std::vector<Point_2> readInputPoints(const std::string& boundaryFilename, const std::string& sitesFilename);
+
+#endif
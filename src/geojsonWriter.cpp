@@ -0,0 +1,130 @@
+#include "geojsonWriter.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// function that appends a number with enough digits to round trip the coordinates
+void appendNumber(std::string& buffer, double value) {
+    char number[32];
+    int length = std::snprintf(number, sizeof(number), "%.17g", value);
+    buffer.append(number, length);
+}
+
+}
+
+// constructor that receives the output stream and the size of the buffer (in bytes)
+GeojsonWriter::GeojsonWriter(std::ostream& out, std::size_t bufferSize):m_out(out), m_bufferSize(bufferSize) {
+    m_buffer.reserve(bufferSize + 4096);
+    m_buffer += "{\"type\":\"FeatureCollection\",\"features\":[";
+}
+
+// the collection is closed if finish() wasn't called
+GeojsonWriter::~GeojsonWriter() {
+    finish();
+}
+
+// writes the center of the circle as a Point (with its radius) and the circle as a Polygon of N segments
+void GeojsonWriter::writeCircle(const LargestEmptyCircle& circle, int N) {
+    double centerX = CGAL::to_double(circle.center.x());
+    double centerY = CGAL::to_double(circle.center.y());
+    double radius = circle.radius();
+
+    // the radius is added as a property of both features
+    std::string radiusProperty = ",\"radius\":";
+    appendNumber(radiusProperty, radius);
+
+    // the center
+    beginFeature("Point", "center", radiusProperty.c_str());
+    appendPoint(centerX, centerY);
+    endFeature("}}");
+
+    // the circle as a polygon with a single ring, the first vertex is repeated at the end to close the ring
+    beginFeature("Polygon", "circle", radiusProperty.c_str());
+    m_buffer += "[[";
+    for (int i = 0; i <= N; i++) {
+        double angle = (2.0 * M_PI * (i % N)) / N;
+        if (i > 0) m_buffer += ',';
+        appendPoint(centerX + radius * std::cos(angle), centerY + radius * std::sin(angle));
+    }
+    endFeature("]]}}");
+}
+
+// writes every site as a Point feature of the given kind
+void GeojsonWriter::writeSites(const std::vector<Point_2>& sites, const char* kind) {
+    for (const Point_2& site : sites) {
+        beginFeature("Point", kind);
+        appendPoint(CGAL::to_double(site.x()), CGAL::to_double(site.y()));
+        endFeature("}}");
+    }
+}
+
+// writes every segment as a LineString feature of the given kind
+void GeojsonWriter::writeSegments(const std::list<Segment_2>& segments, const char* kind) {
+    for (const Segment_2& segment : segments) {
+        beginFeature("LineString", kind);
+        m_buffer += '[';
+        appendPoint(CGAL::to_double(segment.source().x()), CGAL::to_double(segment.source().y()));
+        m_buffer += ',';
+        appendPoint(CGAL::to_double(segment.target().x()), CGAL::to_double(segment.target().y()));
+        endFeature("]}}");
+    }
+}
+
+// writes every candidate point as a Point feature with its distance to the nearest site
+void GeojsonWriter::writeCandidates(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores) {
+    std::string distanceProperty;
+    for (std::size_t i = 0; i < candidatePoints.size(); i++) {
+        // the property is formatted apart (reusing the string) and then passed to the feature
+        distanceProperty.assign(",\"distance\":");
+        appendNumber(distanceProperty, std::sqrt(CGAL::to_double(candidateScores[i])));
+
+        beginFeature("Point", "candidate", distanceProperty.c_str());
+        appendPoint(CGAL::to_double(candidatePoints[i].x()), CGAL::to_double(candidatePoints[i].y()));
+        endFeature("}}");
+    }
+}
+
+// closes the collection and writes what is left in the buffer (the stream is not flushed)
+void GeojsonWriter::finish() {
+    if (m_finished) return;
+    m_finished = true;
+    m_buffer += "]}\n";
+    m_out.write(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+}
+
+// starts a feature with the geometry type and the kind property, the coordinates are written next
+void GeojsonWriter::beginFeature(const char* geometryType, const char* kind, const char* extraProperties) {
+    if (!m_firstFeature) m_buffer += ',';
+    m_firstFeature = false;
+    m_buffer += "\n{\"type\":\"Feature\",\"properties\":{\"kind\":\"";
+    m_buffer += kind;
+    m_buffer += '"';
+    if (extraProperties) m_buffer += extraProperties;
+    m_buffer += "},\"geometry\":{\"type\":\"";
+    m_buffer += geometryType;
+    m_buffer += "\",\"coordinates\":";
+}
+
+// closes the coordinates, the geometry and the feature
+void GeojsonWriter::endFeature(const char* closing) {
+    m_buffer += closing;
+    flushIfFull();
+}
+
+// appends a coordinate pair [x,y]
+void GeojsonWriter::appendPoint(double x, double y) {
+    m_buffer += '[';
+    appendNumber(m_buffer, x);
+    m_buffer += ',';
+    appendNumber(m_buffer, y);
+    m_buffer += ']';
+}
+
+// writes the buffer to the stream once it is full
+void GeojsonWriter::flushIfFull() {
+    if (m_buffer.size() < m_bufferSize) return;
+    m_out.write(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+}
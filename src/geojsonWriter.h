@@ -0,0 +1,55 @@
+#ifndef GEOJSON_WRITER_H
+#define GEOJSON_WRITER_H
+
+#include <list>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// streaming writer of a GeoJSON FeatureCollection, the features are formatted into an internal buffer that is
+// written to the stream in big blocks, the stream is never flushed per feature
+class GeojsonWriter {
+public:
+    // constructor that receives the output stream and the size of the buffer (in bytes)
+    explicit GeojsonWriter(std::ostream& out, std::size_t bufferSize = 1 << 20);
+
+    GeojsonWriter(const GeojsonWriter&) = delete;
+    GeojsonWriter& operator=(const GeojsonWriter&) = delete;
+
+    // the collection is closed if finish() wasn't called
+    ~GeojsonWriter();
+
+    // writes the center of the circle as a Point (with its radius) and the circle as a Polygon of N segments
+    void writeCircle(const LargestEmptyCircle& circle, int N = 40);
+
+    // writes every site as a Point feature of the given kind
+    void writeSites(const std::vector<Point_2>& sites, const char* kind);
+
+    // writes every segment as a LineString feature of the given kind
+    void writeSegments(const std::list<Segment_2>& segments, const char* kind);
+
+    // writes every candidate point as a Point feature with its distance to the nearest site
+    void writeCandidates(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores);
+
+    // closes the collection and writes what is left in the buffer (the stream is not flushed)
+    void finish();
+
+private:
+    // starts a feature with the geometry type and the kind property, the coordinates are written next
+    void beginFeature(const char* geometryType, const char* kind, const char* extraProperties = nullptr);
+    // closes the coordinates, the geometry and the feature
+    void endFeature(const char* closing);
+    // appends a coordinate pair [x,y]
+    void appendPoint(double x, double y);
+    // writes the buffer to the stream once it is full
+    void flushIfFull();
+
+    std::ostream& m_out;
+    std::string m_buffer;
+    std::size_t m_bufferSize;
+    bool m_firstFeature = true;
+    bool m_finished = false;
+};
+
+#endif
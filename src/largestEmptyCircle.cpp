@@ -0,0 +1,400 @@
+#include "largestEmptyCircle.h"
+#include "threadPool.h"
+#include "traceEvents.h"
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <iterator>
+#include <CGAL/convex_hull_2.h>
+#include <CGAL/spatial_sort.h>
+#include <CGAL/squared_distance_2.h>
+
+// function that returns the bounding box of the points, one unit bigger on every side
+Iso_rectangle_2 getBoundingBox(const std::vector<Point_2>& points) {
+    // the minimum and maximum x and y coordinates are calculated
+    auto minX = points[0].x();
+    auto minY = points[0].y();
+    auto maxX = points[0].x();
+    auto maxY = points[0].y();
+    // for all points in the cgal points vector
+    for (const Point_2& point : points) {
+        // the minimum x and y coordinates are updated
+        if (point.x() < minX) minX = point.x();
+        if (point.y() < minY) minY = point.y();
+        // the maximum x and y coordinates are updated
+        if (point.x() > maxX) maxX = point.x();
+        if (point.y() > maxY) maxY = point.y();
+    }
+    // the bounding box bigger than the minimum and maximum x and y coordinates is created
+    return Iso_rectangle_2(minX - 1, minY - 1, maxX + 1, maxY + 1);
+}
+
+// function that inserts the points in the triangulation (this will also compute the Voronoi diagram), with a
+// cancellation token the points are inserted in batches and the token is checked between them
+void triangulate(Delaunay_triangulation_2& dt2, const std::vector<Point_2>& points, const CancellationToken* cancellation) {
+    // the points go in with their ids, the triangulation sorts them along a space filling curve before inserting them
+    std::vector<std::pair<Point_2, SiteId>> sites;
+    sites.reserve(points.size());
+    if (!cancellation || points.size() <= kTriangulationBatchSize) {
+        for (std::size_t i = 0; i < points.size(); i++) sites.emplace_back(points[i], static_cast<SiteId>(i));
+        dt2.insert(sites.begin(), sites.end());
+        return;
+    }
+    // the points are sorted along a space filling curve once, so every batch is inserted next to the previous one
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    CGAL::spatial_sort(order.begin(), order.end(), Spatial_sort_traits_2(CGAL::make_property_map(points)));
+    for (std::size_t i : order) sites.emplace_back(points[i], static_cast<SiteId>(i));
+    for (std::size_t begin = 0; begin < sites.size(); begin += kTriangulationBatchSize) {
+        cancellation->check();
+        std::size_t end = std::min(sites.size(), begin + kTriangulationBatchSize);
+        dt2.insert(sites.begin() + begin, sites.begin() + end);
+    }
+}
+
+// function that returns the segments of the Voronoi diagram of the triangulation cropped to the bounding box
+std::list<Segment_2> getCroppedVoronoi(const Delaunay_triangulation_2& dt2, const Iso_rectangle_2& bbox) {
+    // the cropped Voronoi diagram is created
+    Cropped_voronoi_from_delaunay voronoi(bbox);
+    dt2.draw_dual(voronoi);
+    return voronoi.m_cropped_vd;
+}
+
+// function that returns the convex hull of the points as a polygon
+Polygon_2 getConvexHull(const std::vector<Point_2>& points) {
+    std::vector<std::size_t> ch_points(points.size()), out;
+    std::iota(ch_points.begin(), ch_points.end(), 0);
+    // the convex hull is computed
+    CGAL::convex_hull_2(ch_points.begin(), ch_points.end(), std::back_inserter(out), Convex_hull_traits_2(CGAL::make_property_map(points)));
+    // a polygon is created with the convex hull vertices
+    Polygon_2 ch;
+    // for all vertices in out
+    for (std::size_t i : out) {
+        // the vertex is added to the polygon
+        ch.push_back(points[i]);
+    }
+    return ch;
+}
+
+// function that returns the edges of a polygon as segments
+std::vector<Segment_2> getPolygonSegments(const Polygon_2& polygon) {
+    // vector of segments that represent the edges of the polygon
+    std::vector<Segment_2> segments;
+    // for all vertices in the polygon
+    for (std::size_t i = 0; i < polygon.size(); i++) {
+        // the segment from the vertex to the next one is added to the segments vector
+        segments.push_back(Segment_2(polygon[i], polygon[(i + 1) % polygon.size()]));
+    }
+    return segments;
+}
+
+// function that returns the site nearest to the point, walking the triangulation from the hint (or from any site if
+// the hint is null) to the neighbor closest to the point until no neighbor is closer, unlike nearest_vertex it
+// doesn't touch the triangulation so many threads can use it at the same time (with LEC_PROFILE the steps of the walk
+// are added to steps, if it isn't null)
+Delaunay_triangulation_2::Vertex_handle walkToNearestVertex(const Delaunay_triangulation_2& dt2, const Point_2& point, Delaunay_triangulation_2::Vertex_handle hint, std::uint64_t* steps) {
+    if (dt2.number_of_vertices() == 0) return Delaunay_triangulation_2::Vertex_handle();
+    Delaunay_triangulation_2::Vertex_handle nearest = hint;
+    if (nearest == Delaunay_triangulation_2::Vertex_handle() || dt2.is_infinite(nearest)) nearest = dt2.finite_vertices_begin();
+    Geom_traits_2::Compare_distance_2 compareDistance = dt2.geom_traits().compare_distance_2_object();
+    // in a delaunay triangulation a site that is not the nearest one always has a neighbor closer to the point
+    bool closer = true;
+    while (closer) {
+        closer = false;
+        Delaunay_triangulation_2::Vertex_circulator neighbor = dt2.incident_vertices(nearest), done = neighbor;
+        if (neighbor == nullptr) break;
+        do {
+            // the distance is compared by the traits of the triangulation, so the comparisons are counted with the predicates
+            if (!dt2.is_infinite(neighbor) && compareDistance(point, neighbor->point(), nearest->point()) == CGAL::SMALLER) {
+                nearest = neighbor;
+                closer = true;
+                LEC_PROFILE_ONLY(if (steps) (*steps)++;)
+                break;
+            }
+        } while (++neighbor != done);
+    }
+    return nearest;
+}
+
+// function that returns the vertices of the Voronoi segments inside the convex hull or on its boundary, sorted and
+// without repeated vertices (the cancellation token, if any, is checked before every chunk, and the profile, if any,
+// gets the time and the counters of the filter)
+std::vector<Point_2> getInsideVoronoiVertices(const std::list<Segment_2>& voronoiSegments, const Polygon_2& ch, std::size_t threads, const CancellationToken* cancellation, StageProfile* profile) {
+    LEC_PROFILE_SCOPE(profile ? &profile->insideVerticesSeconds : nullptr);
+    LEC_COUNT_PREDICATES_SCOPE(profile ? &profile->insideVerticesPredicates : nullptr);
+    // vector with the CGAL Point_2 vertices of the Voronoi diagram, sorted and without repeated vertices
+    std::vector<Point_2> voronoiVerticesCGAL;
+    voronoiVerticesCGAL.reserve(2 * voronoiSegments.size());
+
+    // for all segments in the list
+    for (const Segment_2& segment : voronoiSegments) {
+        // the source and target points of the segment are added to the vector
+        voronoiVerticesCGAL.push_back(segment.source());
+        voronoiVerticesCGAL.push_back(segment.target());
+    }
+    std::sort(voronoiVerticesCGAL.begin(), voronoiVerticesCGAL.end());
+    voronoiVerticesCGAL.erase(std::unique(voronoiVerticesCGAL.begin(), voronoiVerticesCGAL.end()), voronoiVerticesCGAL.end());
+
+    // the candidate vertices of the Voronoi diagram, every chunk of vertices is filtered by a thread
+    std::size_t vertexChunks = (voronoiVerticesCGAL.size() + kCandidateChunkSize - 1) / kCandidateChunkSize;
+    std::vector<std::vector<Point_2>> insideVertices(vertexChunks);
+    parallelFor(voronoiVerticesCGAL.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        // a stopped computation skips the remaining chunks (the body can't throw on the helper threads)
+        if (cancellation && cancellation->shouldStop()) return;
+        for (std::size_t i = begin; i < end; i++) {
+            // if vertex is inside the convex hull, it's added to the candidate points of the chunk
+            // here the opposite is checked so points in the boundary are also added
+            if (!ch.has_on_unbounded_side(voronoiVerticesCGAL[i])) {
+                insideVertices[chunk].push_back(voronoiVerticesCGAL[i]);
+            }
+        }
+    });
+    if (cancellation) cancellation->check();
+
+    // the chunks are joined in order so the result doesn't depend on the number of threads
+    std::vector<Point_2> vertices;
+    for (const std::vector<Point_2>& chunk : insideVertices) vertices.insert(vertices.end(), chunk.begin(), chunk.end());
+    LEC_PROFILE_ONLY(if (profile) {
+        profile->voronoiVertices = voronoiVerticesCGAL.size();
+        profile->insideVertices = vertices.size();
+    })
+    return vertices;
+}
+
+// function that returns the intersections of the Voronoi segments with the edges of the convex hull (the cancellation
+// token, if any, is checked before every chunk, and the profile, if any, gets the time and the counters of the tests)
+std::vector<Point_2> getHullIntersections(const std::list<Segment_2>& voronoiSegments, const std::vector<Segment_2>& chSegments, std::size_t threads, const CancellationToken* cancellation, StageProfile* profile) {
+    LEC_PROFILE_SCOPE(profile ? &profile->intersectionSeconds : nullptr);
+    LEC_COUNT_PREDICATES_SCOPE(profile ? &profile->intersectionPredicates : nullptr);
+    // the intersections of the Voronoi segments with the convex hull, every chunk of Voronoi segments is
+    // intersected by a thread
+    std::vector<Segment_2> voronoiSegmentsCGAL(voronoiSegments.begin(), voronoiSegments.end());
+    std::size_t segmentChunks = (voronoiSegmentsCGAL.size() + kCandidateChunkSize - 1) / kCandidateChunkSize;
+    std::vector<std::vector<Point_2>> intersections(segmentChunks);
+    // the intersection tests of every chunk, added up at the end so the threads don't share a counter
+    LEC_PROFILE_ONLY(std::vector<std::uint64_t> chunkTests(segmentChunks);)
+    parallelFor(voronoiSegmentsCGAL.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        if (cancellation && cancellation->shouldStop()) return;
+        // for all segments of the chunk of the cropped Voronoi diagram
+        for (std::size_t i = begin; i < end; i++) {
+            const Segment_2& voronoiSegment = voronoiSegmentsCGAL[i];
+            CGAL::Bbox_2 voronoiBox = voronoiSegment.bbox();
+            // for all segments in the convex hull
+            for (const Segment_2& chSegment : chSegments) {
+                // the segments whose boxes don't overlap can't intersect
+                if (!CGAL::do_overlap(voronoiBox, chSegment.bbox())) continue;
+                LEC_PROFILE_ONLY(chunkTests[chunk]++;)
+                LEC_COUNT_PREDICATES_ONLY(countSegmentIntersection(chSegment, voronoiSegment);)
+                // the intersection of the segments is stored in obj which supports multiple types
+                CGAL::Object obj = CGAL::intersection(chSegment, voronoiSegment);
+                // if obj is a point, it is added to the candidate points of the chunk
+                const Point_2* p = CGAL::object_cast<Point_2>(&obj);
+                if (p) {
+                    intersections[chunk].push_back(*p);
+                }
+            }
+        }
+    });
+    if (cancellation) cancellation->check();
+
+    std::vector<Point_2> points;
+    for (const std::vector<Point_2>& chunk : intersections) points.insert(points.end(), chunk.begin(), chunk.end());
+    LEC_PROFILE_ONLY(if (profile) {
+        profile->boxTests = static_cast<std::uint64_t>(voronoiSegmentsCGAL.size()) * chSegments.size();
+        profile->intersectionTests = std::accumulate(chunkTests.begin(), chunkTests.end(), std::uint64_t(0));
+        profile->hullIntersections = points.size();
+    })
+    return points;
+}
+
+// function that returns the candidate points: the Voronoi vertices inside the convex hull and
+// the intersections of the Voronoi segments with the edges of the convex hull (the cancellation token, if any, is
+// checked before every chunk and OperationCancelled is thrown when it stops the computation)
+std::vector<Point_2> getCandidatePoints(const std::list<Segment_2>& voronoiSegments, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, std::size_t threads, const CancellationToken* cancellation, StageProfile* profile) {
+    // Point_2 vector for the candidate points, the vertices first and then the intersections
+    std::vector<Point_2> candidatePoints = getInsideVoronoiVertices(voronoiSegments, ch, threads, cancellation, profile);
+    std::vector<Point_2> intersections = getHullIntersections(voronoiSegments, chSegments, threads, cancellation, profile);
+    candidatePoints.insert(candidatePoints.end(), intersections.begin(), intersections.end());
+    return candidatePoints;
+}
+
+// function that returns the squared distance from every candidate point to its nearest site (the cancellation
+// token, if any, is checked before every chunk, and the profile, if any, gets the time and the walks)
+std::vector<K::FT> scoreCandidatePoints(const Delaunay_triangulation_2& dt2, const std::vector<Point_2>& candidatePoints, std::size_t threads, const CancellationToken* cancellation, StageProfile* profile) {
+    LEC_PROFILE_SCOPE(profile ? &profile->scoreSeconds : nullptr);
+    LEC_COUNT_PREDICATES_SCOPE(profile ? &profile->scorePredicates : nullptr);
+    // vector for the score of every candidate point, every chunk of candidates is scored by a thread
+    std::vector<K::FT> candidateScores(candidatePoints.size());
+    // the steps of the walks of every chunk
+    LEC_PROFILE_ONLY(std::vector<std::uint64_t> chunkSteps((candidatePoints.size() + kCandidateChunkSize - 1) / kCandidateChunkSize);)
+    parallelFor(candidatePoints.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        if (cancellation && cancellation->shouldStop()) return;
+        // consecutive candidates are usually close, so the walk starts from the nearest site of the previous one
+        Delaunay_triangulation_2::Vertex_handle hint;
+        for (std::size_t i = begin; i < end; i++) {
+            // the nearest neighbor of the candidate point is stored in the nearest_neighbor variable
+            hint = walkToNearestVertex(dt2, candidatePoints[i], hint LEC_PROFILE_ONLY(, &chunkSteps[chunk]));
+            const Point_2& nearest_neighbor = hint->point();
+            // the squared distance between the candidate point and the nearest neighbor is the score
+            candidateScores[i] = CGAL::squared_distance(candidatePoints[i], nearest_neighbor);
+        }
+    });
+    if (cancellation) cancellation->check();
+    LEC_PROFILE_ONLY(if (profile) {
+        profile->nearestVertexWalks = candidatePoints.size();
+        profile->walkSteps = std::accumulate(chunkSteps.begin(), chunkSteps.end(), std::uint64_t(0));
+    })
+    return candidateScores;
+}
+
+// function that returns true if the circle a goes before the circle b: the bigger one, and on a tie the one with
+// the smaller center (by x and then by y), so the order never depends on the order of the candidates
+bool isBetterCircle(const LargestEmptyCircle& a, const LargestEmptyCircle& b) {
+    if (a.squaredRadius != b.squaredRadius) return a.squaredRadius > b.squaredRadius;
+    return a.center < b.center;
+}
+
+// function that returns the k candidates with the biggest score as circles, from the biggest to the smallest, without
+// repeated centers, every thread keeps the best k of its chunks and then they are merged
+std::vector<LargestEmptyCircle> pickLargestEmptyCircles(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores, std::size_t k, std::size_t threads) {
+    std::size_t chunks = (candidatePoints.size() + kCandidateChunkSize - 1) / kCandidateChunkSize;
+    // the best k circles of every chunk, sorted from the best to the worst
+    std::vector<std::vector<LargestEmptyCircle>> chunkBest(chunks);
+    parallelFor(candidatePoints.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        std::vector<LargestEmptyCircle>& best = chunkBest[chunk];
+        // for all candidate points of the chunk
+        for (std::size_t i = begin; i < end; i++) {
+            // a candidate on a site is not an empty circle
+            if (!(candidateScores[i] > 0)) continue;
+            LargestEmptyCircle circle;
+            circle.center = candidatePoints[i];
+            circle.squaredRadius = candidateScores[i];
+            // the circle is kept if it's better than the worst of the best k
+            if (best.size() == k && (k == 0 || !isBetterCircle(circle, best.back()))) continue;
+            // a center can be a candidate more than once (a Voronoi vertex on the convex hull, or the circumcenter of
+            // cocircular faces), the same center has the same score so it's found by the order
+            if (std::binary_search(best.begin(), best.end(), circle, isBetterCircle)) continue;
+            best.insert(std::upper_bound(best.begin(), best.end(), circle, isBetterCircle), circle);
+            if (best.size() > k) best.pop_back();
+        }
+    });
+
+    // the best k of the chunks are merged
+    std::vector<LargestEmptyCircle> circles;
+    for (const std::vector<LargestEmptyCircle>& best : chunkBest) circles.insert(circles.end(), best.begin(), best.end());
+    std::sort(circles.begin(), circles.end(), isBetterCircle);
+    // the same center can be among the best of two chunks
+    circles.erase(std::unique(circles.begin(), circles.end(), [](const LargestEmptyCircle& a, const LargestEmptyCircle& b) { return a.center == b.center; }), circles.end());
+    if (circles.size() > k) circles.resize(k);
+    return circles;
+}
+
+// function that returns the candidate with the biggest score as the largest empty circle
+LargestEmptyCircle pickLargestEmptyCircle(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores, std::size_t threads) {
+    std::vector<LargestEmptyCircle> circles = pickLargestEmptyCircles(candidatePoints, candidateScores, 1, threads);
+    // without candidates the circle is empty
+    return circles.empty() ? LargestEmptyCircle() : circles[0];
+}
+
+// function that returns the sites on the boundary of the circle (the sites that define it)
+std::vector<Point_2> getDefiningSites(const Delaunay_triangulation_2& dt2, const LargestEmptyCircle& circle) {
+    std::vector<Point_2> definingSites;
+    if (dt2.number_of_vertices() == 0) return definingSites;
+    // the sites whose squared distance differs less than this from the squared radius are considered on the circle
+    double tolerance = 1e-9 * CGAL::to_double(circle.squaredRadius);
+
+    // the sites on the boundary are connected in the triangulation, so they are found walking from the nearest one
+    Delaunay_triangulation_2::Vertex_handle nearest = dt2.nearest_vertex(circle.center);
+    std::set<Point_2> visited;
+    std::vector<Delaunay_triangulation_2::Vertex_handle> pending(1, nearest);
+    visited.insert(nearest->point());
+    while (!pending.empty()) {
+        Delaunay_triangulation_2::Vertex_handle v = pending.back();
+        pending.pop_back();
+        definingSites.push_back(v->point());
+        // for all the neighbors of the site
+        Delaunay_triangulation_2::Vertex_circulator neighbor = dt2.incident_vertices(v), done = neighbor;
+        if (neighbor == nullptr) continue;
+        do {
+            if (!dt2.is_infinite(neighbor) && visited.count(neighbor->point()) == 0) {
+                // the neighbor is added if it is at the same distance from the center
+                double difference = CGAL::to_double(CGAL::squared_distance(circle.center, neighbor->point()) - circle.squaredRadius);
+                if (std::abs(difference) <= tolerance) {
+                    visited.insert(neighbor->point());
+                    pending.push_back(neighbor);
+                }
+            }
+        } while (++neighbor != done);
+    }
+    return definingSites;
+}
+
+// function that runs the stages 1 and 2 (triangulation, cropped Voronoi diagram and convex hull) over the points
+void runTriangulationStage(const std::vector<Point_2>& inputPointsCGAL, LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options) {
+    // 1- delanuay triangulation and voronoi diagram
+    {
+        TraceSpan span("triangulation");
+        LEC_PROFILE_SCOPE(&stages.profile.triangulationSeconds);
+        LEC_COUNT_PREDICATES_SCOPE(&stages.profile.triangulationPredicates);
+        triangulate(stages.dt2, inputPointsCGAL, options.cancellation);
+    }
+    if (options.cancellation) options.cancellation->check();
+    {
+        TraceSpan span("voronoi");
+        LEC_PROFILE_SCOPE(&stages.profile.voronoiSeconds);
+        stages.bbox = getBoundingBox(inputPointsCGAL);
+        stages.voronoiSegments = getCroppedVoronoi(stages.dt2, stages.bbox);
+    }
+    LEC_PROFILE_ONLY(
+        stages.profile.sitesInserted = inputPointsCGAL.size();
+        stages.profile.vertices = stages.dt2.number_of_vertices();
+        stages.profile.faces = stages.dt2.number_of_faces();
+        stages.profile.voronoiSegments = stages.voronoiSegments.size();
+    )
+
+    if (options.cancellation) options.cancellation->check();
+
+    // 2- convex hull
+    {
+        TraceSpan span("hull");
+        LEC_PROFILE_SCOPE(&stages.profile.hullSeconds);
+        LEC_COUNT_PREDICATES_SCOPE(&stages.profile.hullPredicates);
+        stages.ch = getConvexHull(inputPointsCGAL);
+        stages.chSegments = getPolygonSegments(stages.ch);
+    }
+    LEC_PROFILE_ONLY(stages.profile.hullVertices = stages.ch.size();)
+}
+
+// function that runs the stage 3 (candidate points) over the output of the stages 1 and 2
+void runCandidateStage(LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options) {
+    // 3- candidate points
+    TraceSpan span("candidates");
+    stages.candidatePoints = getCandidatePoints(stages.voronoiSegments, stages.ch, stages.chSegments, options.threads, options.cancellation, &stages.profile);
+}
+
+// function that runs the stage 4 (scores and largest empty circle) over the candidate points
+void runScoreStage(LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options) {
+    // 4- largest empty circle
+    TraceSpan span("score");
+    stages.candidateScores = scoreCandidatePoints(stages.dt2, stages.candidatePoints, options.threads, options.cancellation, &stages.profile);
+    {
+        TraceSpan pickSpan("pick");
+        LEC_PROFILE_SCOPE(&stages.profile.pickSeconds);
+        stages.topCircles = pickLargestEmptyCircles(stages.candidatePoints, stages.candidateScores, std::max<std::size_t>(1, options.topK), options.threads);
+    }
+    stages.circle = stages.topCircles.empty() ? LargestEmptyCircle() : stages.topCircles[0];
+}
+
+// function that runs every stage over the points and stores the output of each one in stages
+void runLargestEmptyCircleStages(const std::vector<Point_2>& inputPointsCGAL, LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options) {
+    runTriangulationStage(inputPointsCGAL, stages, options);
+    runCandidateStage(stages, options);
+    runScoreStage(stages, options);
+}
+
+// function that receives a vector of points Point_2 and returns its largest empty circle
+LargestEmptyCircle getLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const LargestEmptyCircleOptions& options) {
+    LargestEmptyCircleStages stages;
+    runLargestEmptyCircleStages(inputPointsCGAL, stages, options);
+    return stages.circle;
+}
@@ -0,0 +1,203 @@
+#ifndef LARGEST_EMPTY_CIRCLE_H
+#define LARGEST_EMPTY_CIRCLE_H
+
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <vector>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Delaunay_triangulation_2.h>
+#include <CGAL/Triangulation_data_structure_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/Convex_hull_traits_adapter_2.h>
+#include <CGAL/Spatial_sort_traits_adapter_2.h>
+#include <CGAL/property_map.h>
+#include <CGAL/Polygon_2.h>
+#include "cancellation.h"
+#include "predicateCounters.h"
+#include "stageProfile.h"
+#ifdef LEC_COUNT_PREDICATES
+#include "countingTraits.h"
+#endif
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
+typedef K::Point_2 Point_2;
+typedef K::Iso_rectangle_2 Iso_rectangle_2;
+typedef K::Segment_2 Segment_2;
+typedef K::Ray_2 Ray_2;
+typedef K::Line_2 Line_2;
+// traits of the triangulation, the convex hull and the polygons: the kernel, or the kernel that counts its predicates
+#ifdef LEC_COUNT_PREDICATES
+typedef CountingTraits Geom_traits_2;
+#else
+typedef K Geom_traits_2;
+#endif
+// every vertex of the triangulation keeps the id of its site: the position of the site in the input points
+typedef std::uint32_t SiteId;
+typedef CGAL::Triangulation_vertex_base_with_info_2<SiteId, Geom_traits_2> Vertex_base_2;
+typedef CGAL::Triangulation_data_structure_2<Vertex_base_2> Triangulation_data_structure_2;
+typedef CGAL::Delaunay_triangulation_2<Geom_traits_2, Triangulation_data_structure_2>  Delaunay_triangulation_2;
+typedef CGAL::Convex_hull_traits_adapter_2<Geom_traits_2, CGAL::Pointer_property_map<Point_2>::const_type > Convex_hull_traits_2;
+// traits to sort the indices of points along a space filling curve
+typedef CGAL::Spatial_sort_traits_adapter_2<K, CGAL::Pointer_property_map<Point_2>::const_type> Spatial_sort_traits_2;
+typedef CGAL::Polygon_2<Geom_traits_2> Polygon_2;
+
+// struct that will store the cropped Voronoi diagram
+struct Cropped_voronoi_from_delaunay{
+    // this list will store the segments of the cropped Voronoi diagram
+    std::list<Segment_2> m_cropped_vd;
+    // this is the bounding box that will constrain the Voronoi diagram
+    Iso_rectangle_2 m_bbox;
+
+    // constructor that receives the bounding box
+    Cropped_voronoi_from_delaunay(const Iso_rectangle_2& bbox):m_bbox(bbox){}
+
+    // this template allows to use the same function for rays, lines and segments
+    template <class RSL>
+    // this function crops the input object to the bounding box and stores the segment
+    void crop_and_extract_segment(const RSL& rsl){
+        // the intersection of the rsl and the bounding box is stored in obj which supports multiple types
+        CGAL::Object obj = CGAL::intersection(rsl,m_bbox);
+        // if obj is a segment, it is stored in the list
+        const Segment_2* s=CGAL::object_cast<Segment_2>(&obj);
+        if (s)
+            m_cropped_vd.push_back(*s);
+    }
+
+    // overload the << operator to allow the cropping of rays, lines and segments
+    void operator<<(const Ray_2& ray) {
+        crop_and_extract_segment(ray);
+    }
+
+    void operator<<(const Line_2& line) {
+        crop_and_extract_segment(line);
+    }
+
+    void operator<<(const Segment_2& seg) {
+        crop_and_extract_segment(seg);
+    }
+};
+
+// struct with the center and squared radius of a largest empty circle
+struct LargestEmptyCircle {
+    // the center of the circle
+    Point_2 center;
+    // the squared radius of the circle (the squared distance from the center to the nearest site)
+    K::FT squaredRadius = 0;
+
+    // the radius of the circle
+    double radius() const { return std::sqrt(CGAL::to_double(squaredRadius)); }
+};
+
+// struct that holds the output of every stage of the largest empty circle computation,
+// so the stages can be run one by one and their tables can be stored and restored
+struct LargestEmptyCircleStages {
+    // 1- the delaunay triangulation of the sites and the bounding box used to crop its Voronoi diagram
+    Delaunay_triangulation_2 dt2;
+    Iso_rectangle_2 bbox;
+    // the segments of the cropped Voronoi diagram
+    std::list<Segment_2> voronoiSegments;
+    // 2- the convex hull of the sites and its edges
+    Polygon_2 ch;
+    std::vector<Segment_2> chSegments;
+    // 3- the candidate points
+    std::vector<Point_2> candidatePoints;
+    // 4- the squared distance from every candidate point to its nearest site, and the best candidate
+    std::vector<K::FT> candidateScores;
+    LargestEmptyCircle circle;
+    // the best topK candidates (LargestEmptyCircleOptions::topK), the first one is the circle
+    std::vector<LargestEmptyCircle> topCircles;
+    // the times and counters of the stages (all zero without LEC_PROFILE)
+    StageProfile profile;
+};
+
+// function that returns the bounding box of the points, one unit bigger on every side
+Iso_rectangle_2 getBoundingBox(const std::vector<Point_2>& points);
+
+// number of points inserted between two checks of the cancellation token
+const std::size_t kTriangulationBatchSize = 1 << 16;
+
+// function that inserts the points in the triangulation (this will also compute the Voronoi diagram) with their
+// position as the id of their vertex, with a cancellation token the points are inserted in batches and the token is
+// checked between them
+void triangulate(Delaunay_triangulation_2& dt2, const std::vector<Point_2>& points, const CancellationToken* cancellation = nullptr);
+
+// function that returns the segments of the Voronoi diagram of the triangulation cropped to the bounding box
+std::list<Segment_2> getCroppedVoronoi(const Delaunay_triangulation_2& dt2, const Iso_rectangle_2& bbox);
+
+// function that returns the convex hull of the points as a polygon
+Polygon_2 getConvexHull(const std::vector<Point_2>& points);
+
+// function that returns the edges of a polygon as segments
+std::vector<Segment_2> getPolygonSegments(const Polygon_2& polygon);
+
+// number of candidate points handled together by a thread (64 KB of points, so a chunk stays in the cache),
+// the chunks don't depend on the number of threads so the results don't either
+const std::size_t kCandidateChunkSize = 4096;
+
+// options of the largest empty circle computation
+struct LargestEmptyCircleOptions {
+    // number of threads for the candidate stages (0 is one per hardware thread)
+    std::size_t threads = 1;
+    // number of circles kept in LargestEmptyCircleStages::topCircles
+    std::size_t topK = 1;
+    // token checked between the stages and inside their loops (the stages throw OperationCancelled), null if the
+    // computation can't be cancelled
+    const CancellationToken* cancellation = nullptr;
+};
+
+// function that returns the site nearest to the point, walking the triangulation from the hint (or from any site if
+// the hint is null) to the neighbor closest to the point until no neighbor is closer, unlike nearest_vertex it
+// doesn't touch the triangulation so many threads can use it at the same time (with LEC_PROFILE the steps of the walk
+// are added to steps, if it isn't null)
+Delaunay_triangulation_2::Vertex_handle walkToNearestVertex(const Delaunay_triangulation_2& dt2, const Point_2& point, Delaunay_triangulation_2::Vertex_handle hint = Delaunay_triangulation_2::Vertex_handle(), std::uint64_t* steps = nullptr);
+
+// function that returns the vertices of the Voronoi segments inside the convex hull or on its boundary, sorted and
+// without repeated vertices (the cancellation token, if any, is checked before every chunk, and the profile, if any,
+// gets the time and the counters of the filter)
+std::vector<Point_2> getInsideVoronoiVertices(const std::list<Segment_2>& voronoiSegments, const Polygon_2& ch, std::size_t threads = 1, const CancellationToken* cancellation = nullptr, StageProfile* profile = nullptr);
+
+// function that returns the intersections of the Voronoi segments with the edges of the convex hull (the cancellation
+// token, if any, is checked before every chunk, and the profile, if any, gets the time and the counters of the tests)
+std::vector<Point_2> getHullIntersections(const std::list<Segment_2>& voronoiSegments, const std::vector<Segment_2>& chSegments, std::size_t threads = 1, const CancellationToken* cancellation = nullptr, StageProfile* profile = nullptr);
+
+// function that returns the candidate points: the Voronoi vertices inside the convex hull and
+// the intersections of the Voronoi segments with the edges of the convex hull (the cancellation token, if any, is
+// checked before every chunk and OperationCancelled is thrown when it stops the computation)
+std::vector<Point_2> getCandidatePoints(const std::list<Segment_2>& voronoiSegments, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, std::size_t threads = 1, const CancellationToken* cancellation = nullptr, StageProfile* profile = nullptr);
+
+// function that returns the squared distance from every candidate point to its nearest site (the cancellation
+// token, if any, is checked before every chunk, and the profile, if any, gets the time and the walks)
+std::vector<K::FT> scoreCandidatePoints(const Delaunay_triangulation_2& dt2, const std::vector<Point_2>& candidatePoints, std::size_t threads = 1, const CancellationToken* cancellation = nullptr, StageProfile* profile = nullptr);
+
+// function that returns true if the circle a goes before the circle b: the bigger one, and on a tie the one with
+// the smaller center (by x and then by y), so the order never depends on the order of the candidates
+bool isBetterCircle(const LargestEmptyCircle& a, const LargestEmptyCircle& b);
+
+// function that returns the k candidates with the biggest score as circles, from the biggest to the smallest, without
+// repeated centers, every thread keeps the best k of its chunks and then they are merged
+std::vector<LargestEmptyCircle> pickLargestEmptyCircles(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores, std::size_t k, std::size_t threads = 1);
+
+// function that returns the candidate with the biggest score as the largest empty circle
+LargestEmptyCircle pickLargestEmptyCircle(const std::vector<Point_2>& candidatePoints, const std::vector<K::FT>& candidateScores, std::size_t threads = 1);
+
+// function that returns the sites on the boundary of the circle (the sites that define it)
+std::vector<Point_2> getDefiningSites(const Delaunay_triangulation_2& dt2, const LargestEmptyCircle& circle);
+
+// function that runs the stages 1 and 2 (triangulation, cropped Voronoi diagram and convex hull) over the points
+void runTriangulationStage(const std::vector<Point_2>& inputPointsCGAL, LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options = LargestEmptyCircleOptions());
+
+// function that runs the stage 3 (candidate points) over the output of the stages 1 and 2
+void runCandidateStage(LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options = LargestEmptyCircleOptions());
+
+// function that runs the stage 4 (scores and largest empty circle) over the candidate points
+void runScoreStage(LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options = LargestEmptyCircleOptions());
+
+// function that runs every stage over the points and stores the output of each one in stages, throws
+// OperationCancelled if the cancellation token of the options stops the computation
+void runLargestEmptyCircleStages(const std::vector<Point_2>& inputPointsCGAL, LargestEmptyCircleStages& stages, const LargestEmptyCircleOptions& options = LargestEmptyCircleOptions());
+
+// function that receives a vector of points Point_2 and returns its largest empty circle
+LargestEmptyCircle getLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const LargestEmptyCircleOptions& options = LargestEmptyCircleOptions());
+
+#endif
@@ -0,0 +1,132 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "processPool.h"
+#include "regionBatch.h"
+#include "threadPool.h"
+#include "traceEvents.h"
+
+// prints how to use the program
+void printUsage() {
+    std::cerr << "Usage: LargestEmptyCircleBatch [--threads N] [--processes N | --pipeline] [--output FILE] [--trace FILE] [DATA_DIRECTORY]" << std::endl;
+    std::cerr << "Computes the largest empty circle of every region (DATA_DIRECTORY/<region>/geojson/boundary.geojson and" << std::endl;
+    std::cerr << "schools.geojson) and writes one JSON line per region (by default to the standard output)." << std::endl;
+    std::cerr << "With --processes the regions are solved by N worker processes instead of threads, and a region whose" << std::endl;
+    std::cerr << "worker dies is retried on a new worker. With --pipeline the stages of the regions overlap: a region is" << std::endl;
+    std::cerr << "read while the previous one is triangulated." << std::endl;
+    std::cerr << "With --trace the spans of every region and stage on every thread are written at exit as Chrome trace" << std::endl;
+    std::cerr << "event JSON (open it in chrome://tracing or https://ui.perfetto.dev)." << std::endl;
+}
+
+int main(int argc, char** argv) {
+    // the data directory, the number of threads (0 is one per hardware thread) and the output file
+    std::string dataDirectory = "data";
+    std::size_t threads = 0;
+    // the number of worker processes (--processes), 0 if the regions are solved by threads
+    std::size_t processes = 0;
+    // if the stages of the regions run in a pipeline (--pipeline) instead of a region per task
+    bool pipelined = false;
+    std::string outputFilename;
+    // the Chrome trace event file (--trace), empty if the spans aren't recorded
+    std::string traceFilename;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc) threads = std::stoul(argv[++i]);
+        else if (argument == "--processes" && i + 1 < argc) processes = std::stoul(argv[++i]);
+        else if (argument == "--pipeline") pipelined = true;
+        else if (argument == "--output" && i + 1 < argc) outputFilename = argv[++i];
+        else if (argument == "--trace" && i + 1 < argc) traceFilename = argv[++i];
+        else if (argument == "--help") {
+            printUsage();
+            return 0;
+        }
+        else dataDirectory = argument;
+    }
+    // the pipeline runs on threads, so it can't be split in processes
+    if (pipelined && processes > 0) {
+        std::cerr << "--pipeline can't be used with --processes" << std::endl;
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (!outputFilename.empty()) {
+        outputFile.open(outputFilename, std::ios::trunc);
+        if (!outputFile) {
+            std::cerr << "Could not open " << outputFilename << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+
+    // the regions come sorted from the biggest to the smallest, so the big ones don't end up as stragglers
+    std::vector<Region> regions = discoverRegions(dataDirectory);
+    if (regions.empty()) {
+        std::cerr << "No regions found in " << dataDirectory << std::endl;
+        return 1;
+    }
+
+    // the worker processes would record their spans in their own copy of the buffers, so only threads are traced
+    if (!traceFilename.empty()) {
+        if (processes > 0) std::cerr << "--trace is ignored with --processes" << std::endl;
+        else startTrace(traceFilename);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::mutex outputMutex;
+    std::size_t failed = 0;
+    if (pipelined) {
+        if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        auto statistics = solveRegionsPipelined(regions, threads, [&output, &failed](const RegionResult& result) {
+            output << formatRegionResult(result) << '\n';
+            if (!result.ok) failed++;
+        });
+        // the time every stage was busy shows which one limits the pipeline
+        for (const auto& stage : statistics) {
+            std::cerr << stage.name << ": " << stage.workers << " workers, " << stage.items << " regions, " << stage.busySeconds << " s busy" << std::endl;
+        }
+    } else if (processes > 0) {
+        // the workers are forked with the list of regions, so a job is only the number of the region
+        ProcessPool pool([&regions](const std::string& job) { return formatRegionResult(solveRegion(regions[std::stoul(job)])); }, processes);
+        threads = pool.size();
+        std::vector<std::string> jobs;
+        for (std::size_t i = 0; i < regions.size(); i++) jobs.push_back(std::to_string(i));
+        pool.run(jobs, [&regions, &output, &failed](std::size_t job, bool ok, const std::string& record) {
+            // a region whose worker died every time gets an error record
+            if (!ok) {
+                RegionResult result;
+                result.name = regions[job].name;
+                result.error = record;
+                output << formatRegionResult(result) << '\n';
+                failed++;
+                return;
+            }
+            output << record << '\n';
+            if (nlohmann::json::parse(record).contains("error")) failed++;
+        });
+        if (pool.crashes() > 0) std::cerr << pool.crashes() << " workers died and were replaced" << std::endl;
+    } else {
+        ThreadPool pool(threads);
+        threads = pool.size();
+        for (const Region& region : regions) {
+            pool.submit([&region, &output, &outputMutex, &failed]() {
+                RegionResult result = solveRegion(region);
+                std::string record = formatRegionResult(result);
+                // one record per region, written as soon as the region is solved
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output << record << '\n';
+                if (!result.ok) failed++;
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    output.flush();
+
+    // the throughput report
+    std::cerr << regions.size() << " regions (" << failed << " failed) in " << seconds << " s with " << threads << (processes > 0 ? " processes: " : " threads: ")
+              << regions.size() / seconds << " regions/s" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
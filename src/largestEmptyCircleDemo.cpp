@@ -5,6 +5,7 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include "glad.h"
+#include "pointGenerators.h"
 #include <GLFW/glfw3.h>
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Delaunay_triangulation_2.h>
@@ -163,26 +164,32 @@ struct Cropped_voronoi_from_delaunay{
     }
 };
 
-// function that returns a vector of points that represent the vertices of the Voronoi diagram
-std::vector<Point_2> getCGALPoints(std::vector<float> vertices){
-    std::vector<Point_2> points;
-    for (size_t i = 0; i < vertices.size(); i += 6) {
-        points.push_back(Point_2(vertices[i], vertices[i + 1]));
+// function that returns the GLAD vertices (position and color) of the input points, only the vertices are converted to
+// float, the points given to CGAL keep their double coordinates
+std::vector<float> getGLADPoints(const std::vector<Point_2>& points){
+    std::vector<float> vertices;
+    for (const Point_2& point : points) {
+        // position
+        vertices.push_back(static_cast<float>(CGAL::to_double(point.x())));
+        vertices.push_back(static_cast<float>(CGAL::to_double(point.y())));
+        vertices.push_back(0.0f);
+        // color
+        vertices.push_back(inputPointsColor[0]);
+        vertices.push_back(inputPointsColor[1]);
+        vertices.push_back(inputPointsColor[2]);
     }
-    return points;
+    return vertices;
 }
 
 // function that receves a vector of points gladPoints and calculates the Voronoi diagram, the convex hull and the largest empty circle,
 // then returns two vectors of floats that represent the vertices and edges of the whole figure
-std::tuple<std::vector<float>, std::vector<float>, std::vector<float>> getLargestEmptyCircle(std::vector<float> inputPointsGLAD) {
+std::tuple<std::vector<float>, std::vector<float>, std::vector<float>> getLargestEmptyCircle(std::vector<Point_2> inputPointsCGAL) {
     // this vector will hold the GLAD output points vertices
     std::vector<float> outputPointsVerticesGLAD;
     // this vector will hold the GLAD output edges vertices
     std::vector<float> outputEdgesVerticesGLAD;
 
     // 1- delanuay triangulation and voronoi diagram
-    // the input points are stored in a vector of CGAL points
-    std::vector<Point_2> inputPointsCGAL = getCGALPoints(inputPointsGLAD);
     // the triangulation object is created
     Delaunay_triangulation_2 dt2;
     // the points are inserted in the triangulation (this will also compute the Voronoi diagram)
@@ -398,6 +405,7 @@ std::tuple<std::vector<float>, std::vector<float>, std::vector<float>> getLarges
     // to GLAD
     // vertices
     // the original points are added to the output points vertices
+    std::vector<float> inputPointsGLAD = getGLADPoints(inputPointsCGAL);
     outputPointsVerticesGLAD.insert(outputPointsVerticesGLAD.end(), inputPointsGLAD.begin(), inputPointsGLAD.end());
     // the vertices of the Voronoi diagram are added to the output points vertices
     outputPointsVerticesGLAD.insert(outputPointsVerticesGLAD.end(), voronoiVerticesGLAD.begin(), voronoiVerticesGLAD.end());
@@ -438,10 +446,11 @@ Point_2 transformPointToRange(Point_2 point, float minX, float minY, float maxX,
     return Point_2(x, y);
 }
 
-// funtion to generate random points in -1, 1 range
-std::vector<float> generateRandomPoints() {
-    // vector for the points vertices
-    std::vector<float> pointVertices;
+// funtion to generate random points in -1, 1 range, the same seed always gives the same points (in double, so the tiny
+// jitter of the near collinear points reaches CGAL)
+std::vector<Point_2> generateRandomPoints() {
+    // vector for the points
+    std::vector<Point_2> points;
 
     // ask the user if they want to show the Voronoi diagram
     std::cout << "Do you want to show the Voronoi diagram? (y/n): ";
@@ -475,50 +484,34 @@ std::vector<float> generateRandomPoints() {
     std::cout << "Enter the number of points: ";
     std::cin >> n;
 
-    // the user is asked if they want to generate the points randomly in a box shape or a circle shape
-    std::cout << "Do you want to generate the points in a box shape or a circle shape? (b/c): ";
+    // the user is asked for the shape of the points, the degenerate ones stress the exact predicates of CGAL
+    std::cout << "Do you want to generate the points in a box shape, a circle shape, clusters, a grid, almost a line or with many duplicates? (b/c/k/g/l/d): ";
     char shape;
     std::cin >> shape;
 
-    if (shape == 'b') {
-        // the points are generated
-        for (int i = 0; i < n; i++) {
-            float x = -1.0f + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (2.0f)));
-            float y = -1.0f + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (2.0f)));
-            // position
-            pointVertices.push_back(x);
-            pointVertices.push_back(y);
-            pointVertices.push_back(0.0f);
-            // color
-            pointVertices.push_back(inputPointsColor[0]);
-            pointVertices.push_back(inputPointsColor[1]);
-            pointVertices.push_back(inputPointsColor[2]);
-        }
-    } else if (shape == 'c') {
-        // the points are generated inside a circle of radius 1 centered at (0, 0)
-        for (int i = 0; i < n; i++) {
-            float angle = static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (2.0f * M_PI)));
-            float radius = static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / 1.0f));
-            float x = radius * std::cos(angle);
-            float y = radius * std::sin(angle);
-            // position
-            pointVertices.push_back(x);
-            pointVertices.push_back(y);
-            pointVertices.push_back(0.0f);
-            // color
-            pointVertices.push_back(inputPointsColor[0]);
-            pointVertices.push_back(inputPointsColor[1]);
-            pointVertices.push_back(inputPointsColor[2]);
-        }
-    }
+    // the seed of the generator, the same seed always gives the same points
+    std::cout << "Enter the seed: ";
+    std::uint64_t seed;
+    std::cin >> seed;
+
+    PointGeneratorOptions options;
+    options.seed = seed;
+    options.xmin = options.ymin = -1.0;
+    options.xmax = options.ymax = 1.0;
+    if (shape == 'c') options.distribution = PointDistribution::Disk;
+    else if (shape == 'k') options.distribution = PointDistribution::Clustered;
+    else if (shape == 'g') options.distribution = PointDistribution::Grid;
+    else if (shape == 'l') options.distribution = PointDistribution::NearCollinear;
+    else if (shape == 'd') options.distribution = PointDistribution::Duplicates;
+    else options.distribution = PointDistribution::Uniform;
+    // the points are generated
+    std::vector<double> coordinates = generatePoints(static_cast<std::size_t>(std::max(n, 0)), options);
+    for (std::size_t i = 0; i + 1 < coordinates.size(); i += 2) points.push_back(Point_2(coordinates[i], coordinates[i + 1]));
 
-    return pointVertices;
+    return points;
 }
 
 int main(int, char**) {
-    // Seed the random number generator with the current time
-    srand(static_cast<unsigned int>(time(NULL)));
-
     // Initialize window and context
     GLFWwindow* window = initWindowAndContext();
     // if window or context initialization failed, return -1
@@ -527,16 +520,18 @@ int main(int, char**) {
     // Create shader program
     unsigned int shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
 
-    // read from generateRandomPoints() to read the input points from a geojson file
-    std::vector<float> pointVertices = generateRandomPoints();
+    // the input points are generated by generateRandomPoints()
+    std::vector<Point_2> inputPoints = generateRandomPoints();
 
+    // vector for the point vertices
+    std::vector<float> pointVertices;
     // vector for the line vertices
     std::vector<float> lineVertices;
     // vector for the largest empty circle vertices
     std::vector<float> circleVertices;
 
     // the processed data is obtained
-    std::tuple<std::vector<float>, std::vector<float>, std::vector<float>> largestEmptyCircle = getLargestEmptyCircle(pointVertices);
+    std::tuple<std::vector<float>, std::vector<float>, std::vector<float>> largestEmptyCircle = getLargestEmptyCircle(inputPoints);
 
     // the points vertices are set
     pointVertices = std::get<0>(largestEmptyCircle);
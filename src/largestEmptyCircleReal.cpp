@@ -1,255 +1,288 @@
 #include <utility> 
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <fstream>
-#include <nlohmann/json.hpp>
-#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
-#include <CGAL/Delaunay_triangulation_2.h>
-#include <CGAL/convex_hull_2.h>
-#include <CGAL/Convex_hull_traits_adapter_2.h>
-#include <CGAL/property_map.h>
-#include <CGAL/Polygon_2.h>
-#include <CGAL/squared_distance_2.h>
-#include <iterator>
-
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef K::Point_2 Point_2;
-typedef K::Iso_rectangle_2 Iso_rectangle_2;
-typedef K::Segment_2 Segment_2;
-typedef K::Ray_2 Ray_2;
-typedef K::Line_2 Line_2;
-typedef CGAL::Delaunay_triangulation_2<K>  Delaunay_triangulation_2;
-typedef CGAL::Convex_hull_traits_adapter_2<K, CGAL::Pointer_property_map<Point_2>::type > Convex_hull_traits_2;
-typedef CGAL::Polygon_2<K> Polygon_2;
-
-// struct that will store the cropped Voronoi diagram
-struct Cropped_voronoi_from_delaunay{
-    // this list will store the segments of the cropped Voronoi diagram
-    std::list<Segment_2> m_cropped_vd;
-    // this is the bounding box that will constrain the Voronoi diagram
-    Iso_rectangle_2 m_bbox;
-
-    // constructor that receives the bounding box
-    Cropped_voronoi_from_delaunay(const Iso_rectangle_2& bbox):m_bbox(bbox){}
-
-    // this template allows to use the same function for rays, lines and segments
-    template <class RSL>
-    // this function crops the input object to the bounding box and stores the segment
-    void crop_and_extract_segment(const RSL& rsl){
-        // the intersection of the rsl and the bounding box is stored in obj which supports multiple types
-        CGAL::Object obj = CGAL::intersection(rsl,m_bbox);
-        // if obj is a segment, it is stored in the list
-        const Segment_2* s=CGAL::object_cast<Segment_2>(&obj);
-        if (s) 
-            m_cropped_vd.push_back(*s);
-    }
-
-    // overload the << operator to allow the cropping of rays, lines and segments
-    void operator<<(const Ray_2& ray) {
-        crop_and_extract_segment(ray);
-    }
-
-    void operator<<(const Line_2& line) {
-        crop_and_extract_segment(line); 
-    }
-
-    void operator<<(const Segment_2& seg) {
-        crop_and_extract_segment(seg); 
-    }
-};
-
-// function that receves a vector of points Point_2 and calculates the Voronoi diagram, the convex hull and the largest empty circle,
-// then prints the center and the radius of the largest empty circle 
-void getLargestEmptyCircle(std::vector<Point_2> inputPointsCGAL) {
-    // 1- delanuay triangulation and voronoi diagram
-    // the triangulation object is created
-    Delaunay_triangulation_2 dt2;
-    // the points are inserted in the triangulation (this will also compute the Voronoi diagram)
-    dt2.insert(inputPointsCGAL.begin(), inputPointsCGAL.end());
-    // the minimum and maximum x and y coordinates are calculated
-    auto minX = inputPointsCGAL[0].x();
-    auto minY = inputPointsCGAL[0].y();
-    auto maxX = inputPointsCGAL[0].x();
-    auto maxY = inputPointsCGAL[0].y();
-    // for all points in the cgal points vector
-    for (const Point_2& point : inputPointsCGAL) {
-        // the minimum x and y coordinates are updated
-        if (point.x() < minX) minX = point.x();
-        if (point.y() < minY) minY = point.y();
-        // the maximum x and y coordinates are updated
-        if (point.x() > maxX) maxX = point.x();
-        if (point.y() > maxY) maxY = point.y();
-    }
-    // the bounding box bigger than the minimum and maximum x and y coordinates is created
-    Iso_rectangle_2 bbox(minX - 1, minY - 1, maxX + 1, maxY + 1);
-    // the cropped Voronoi diagram is created
-    Cropped_voronoi_from_delaunay voronoi(bbox);
-    dt2.draw_dual(voronoi);
-
-    // set with the CGAL Point_2 vertices of the Voronoi diagram
-    std::set<Point_2> voronoiVerticesCGAL;
-
-    // for all segments in the list
-    for (const Segment_2& segment : voronoi.m_cropped_vd) {
-        // the source and target points of the segment are extracted
-        Point_2 source = segment.source();
-        Point_2 target = segment.target();
-        // the source and target points are added to the set
-        voronoiVerticesCGAL.insert(source);
-        voronoiVerticesCGAL.insert(target);
-    }
-
-    // 2- convex hull
-    std::vector<std::size_t> ch_points(inputPointsCGAL.size()), out;
-    std::iota(ch_points.begin(), ch_points.end(), 0);
-    // the convex hull is computed
-    CGAL::convex_hull_2(ch_points.begin(), ch_points.end(), std::back_inserter(out), Convex_hull_traits_2(CGAL::make_property_map(inputPointsCGAL)));
-    // vector for the vertices of the convex hull, only with the x and y coordinates
-    std::vector<float> convexHullVerticesXY;
-    // a polygon is created with the convex hull vertices
-    Polygon_2 ch;
-    // for all vertices in out
-    for (std::size_t i : out) {
-        // the coordinates are converted to float and added to the vector
-        convexHullVerticesXY.push_back(CGAL::to_double(inputPointsCGAL[i].x()));
-        convexHullVerticesXY.push_back(CGAL::to_double(inputPointsCGAL[i].y()));
-        // the vertex is added to the polygon
-        ch.push_back(inputPointsCGAL[i]);
-    }
-    // vector of segments that represent the edges of the convex hull
-    std::vector<Segment_2> chSegments;
-    // for all vertices in convexHullVerticesXY
-    for (size_t i = 0; i < convexHullVerticesXY.size(); i += 2) {
-        // the segment is added to the segments vector
-        chSegments.push_back(Segment_2(Point_2(convexHullVerticesXY[i], convexHullVerticesXY[i + 1]), Point_2(convexHullVerticesXY[(i + 2) % convexHullVerticesXY.size()], convexHullVerticesXY[(i + 3) % convexHullVerticesXY.size()])));
-    }
-
-    // 3- candidate points
-    // Point_2 vector for the candidate points
-    std::vector<Point_2> candidatePoints;
-    // the candidate vertices of the Voronoi diagram are added to the edges vector
-    for (const Point_2& vertex : voronoiVerticesCGAL) {
-        // if vertex is inside the convex hull, it's added to the edges vector
-        // here the opposite is checked so points in the boundary are also added
-        if (!ch.has_on_unbounded_side(vertex)) {
-            /// the vertex is added to the candidate points vector
-            candidatePoints.push_back(vertex);
-        }
-    }
+#include <string>
+#include <stdexcept>
+#include "largestEmptyCircle.h"
+#include "compressedStream.h"
+#include "coverageCurve.h"
+#include "geojsonReader.h"
+#include "geojsonWriter.h"
+#include "nearestSites.h"
+#include "outOfCoreLargestEmptyCircle.h"
+#include "shardedLargestEmptyCircle.h"
+#include "tiledLargestEmptyCircle.h"
+#include "triangulationSnapshot.h"
 
-    // for all segments in the convex hull
-    for (const Segment_2& chSegment : chSegments) {
-        // for all segments in the cropped Voronoi diagram
-        for (const Segment_2& voronoiSegment : voronoi.m_cropped_vd) {
-            // the intersection of the segments is stored in obj which supports multiple types
-            CGAL::Object obj = CGAL::intersection(chSegment, voronoiSegment);
-            // if obj is a point, it is stored in the list
-            const Point_2* p = CGAL::object_cast<Point_2>(&obj);
-            if (p) {
-                // the vertex is added to the candidate points vector
-                candidatePoints.push_back(*p);
-            }
-        }
+// funtion that asks the user for the geojson files and returns a vector of Point_2 with the points
+std::vector<Point_2> readInputPointsFrom() {
+    // the user can pick the file to read the input points from
+    // for the boundary
+    std::string boundaryFilename;
+    std::cout << "Enter the geojson file route for the boundary: ";
+    std::cin >> boundaryFilename;
+
+    // for the points inside the boundary
+    std::string sitesFilename;
+    std::cout << "Enter the geojson file route for the points inside the boundary: ";
+    std::cin >> sitesFilename;
+
+    return readInputPoints(boundaryFilename, sitesFilename);
+}
+
+// function that runs the stages over the points, using the snapshot of the directory (if any) to skip
+// the triangulation and the candidate stages when the points haven't changed
+void runLargestEmptyCircleStages(const std::vector<Point_2>& inputPointsCGAL, const std::string& snapshotDirectory, const LargestEmptyCircleOptions& options, LargestEmptyCircleStages& stages) {
+    // without a snapshot directory every stage is run
+    if (snapshotDirectory.empty()) {
+        runLargestEmptyCircleStages(inputPointsCGAL, stages, options);
+        return;
     }
 
-    // 4- largest empty circle
-    // the largest empty circle is computed
-    // the center and squared radius of the largest empty circle are stored in the variables
-    Point_2 center;
-    K::FT squared_radius = 0;
-
-    // for all candidate points
-    for (const Point_2& candidatePoint : candidatePoints) {
-        // the nearest neighbor of the candidate point is stored in the nearest_neighbor variable
-        Point_2 nearest_neighbor = dt2.nearest_vertex(candidatePoint)->point();
-        // the squared distance between the candidate point and the nearest neighbor is stored in the squared_distance variable
-        K::FT squared_distance = CGAL::squared_distance(candidatePoint, nearest_neighbor);
-        // if the squared distance is greater than the squared radius
-        if (squared_distance > squared_radius) {
-            // the squared radius is set to the squared distance
-            squared_radius = squared_distance;
-            // the center is set to the candidate point
-            center = candidatePoint;
-        }
+    // the snapshot is keyed by the content hash of the points
+    std::uint64_t inputHash = hashInputPoints(inputPointsCGAL);
+    std::string snapshotFilename = getSnapshotFilename(snapshotDirectory, inputHash);
+    // warm start: the triangulation and the candidate tables are mapped back from the snapshot
+    if (readSnapshot(snapshotFilename, inputHash, stages)) {
+        // the snapshot only keeps the best circle, the others are picked again from the candidate tables
+        if (options.topK > 1) stages.topCircles = pickLargestEmptyCircles(stages.candidatePoints, stages.candidateScores, options.topK, options.threads);
+        return;
     }
 
-    // the largest empty circle is drawn
-    // the squared radius is converted to float
-    float radius = std::sqrt(CGAL::to_double(squared_radius));
+    // cold start: every stage is run and the snapshot is written for the next run
+    runLargestEmptyCircleStages(inputPointsCGAL, stages, options);
+    if (!writeSnapshot(snapshotFilename, inputHash, stages)) {
+        std::cerr << "Could not write the snapshot " << snapshotFilename << std::endl;
+    }
+}
 
-    // the center of the largest empty circle is printed
-    std::cout << "Center of the largest empty circle: " << "Longitude: " << CGAL::to_double(center.x()) << " Latitude: " << CGAL::to_double(center.y()) << std::endl;
-    // the radius of the largest empty circle is printed
-    std::cout << "Radius of the largest empty circle: " << radius << std::endl;
+// function that writes the circle, its defining sites and optionally the Voronoi segments and the candidate points
+// to a geojson file ("-" is the standard output), compressed if the file ends with .gz or .zst
+bool writeGeojson(const std::string& filename, LargestEmptyCircleStages& stages, bool withVoronoi, bool withCandidates) {
+    std::unique_ptr<CompressingOutputStream> file;
+    if (filename != "-") {
+        file.reset(new CompressingOutputStream(filename));
+        if (!file->isOpen()) return false;
+    }
+    GeojsonWriter writer(file ? *file : std::cout);
+    writer.writeCircle(stages.circle);
+    writer.writeSites(getDefiningSites(stages.dt2, stages.circle), "site");
+    if (withVoronoi) {
+        // a warm start doesn't restore the Voronoi segments, they are cropped again from the triangulation
+        if (stages.voronoiSegments.empty()) stages.voronoiSegments = getCroppedVoronoi(stages.dt2, stages.bbox);
+        writer.writeSegments(stages.voronoiSegments, "voronoi");
+    }
+    if (withCandidates) writer.writeCandidates(stages.candidatePoints, stages.candidateScores);
+    writer.finish();
+    return !file || file->close();
 }
 
-// funtion that reads the input points from a geojson file and returns a vector of Point_2 with the points
-std::vector<Point_2> readInputPointsFrom() {
-    // vector for the cgal points from the geojson file
-    std::vector<Point_2> pointsCGAL;
+int main(int argc, char** argv) {
+    // directory where the triangulation snapshots are stored (--snapshot-dir), empty if they aren't used
+    std::string snapshotDirectory;
+    // geojson file for the results (--geojson), and if the Voronoi segments and candidate points are added to it
+    std::string geojsonFilename;
+    bool withVoronoi = false;
+    bool withCandidates = false;
+    // number of threads for the candidate stages (--threads, 0 is one per hardware thread) and number of circles (--top)
+    LargestEmptyCircleOptions options;
+    // if the sites are solved by tiles (--tiled) and the number of tiles on each side of the grid (--tiles, 0 is automatic)
+    bool tiled = false;
+    TiledLargestEmptyCircleOptions tiledOptions;
+    // seconds the computation may take (--timeout), 0 if there is no limit
+    double timeout = 0;
+    CancellationToken cancellation;
+    // number of worker processes for the tiles (--processes), 0 if the tiles are solved by threads
+    std::size_t processes = 0;
+    // directory for the tiles of the out of core mode (--out-of-core), empty if the input is read in memory
+    OutOfCoreOptions outOfCoreOptions;
+    // geojson file with the points whose nearest site is asked (--nearest), empty if there are none
+    std::string nearestFilename;
+    // number of radii of the coverage curve (--coverage), 0 if it isn't asked
+    std::size_t coverageSteps = 0;
+    // if the times and counters of the stages are printed to the standard error (--profile)
+    bool profile = false;
+    // the geojson files can be given as arguments instead of being asked
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--snapshot-dir" && i + 1 < argc) snapshotDirectory = argv[++i];
+        else if (argument == "--geojson" && i + 1 < argc) geojsonFilename = argv[++i];
+        else if (argument == "--with-voronoi") withVoronoi = true;
+        else if (argument == "--with-candidates") withCandidates = true;
+        else if (argument == "--threads" && i + 1 < argc) options.threads = std::stoul(argv[++i]);
+        else if (argument == "--top" && i + 1 < argc) options.topK = std::stoul(argv[++i]);
+        else if (argument == "--tiled") tiled = true;
+        else if (argument == "--tiles" && i + 1 < argc) tiledOptions.tilesPerSide = std::stoul(argv[++i]);
+        else if (argument == "--timeout" && i + 1 < argc) timeout = std::stod(argv[++i]);
+        else if (argument == "--processes" && i + 1 < argc) processes = std::stoul(argv[++i]);
+        else if (argument == "--coverage" && i + 1 < argc) coverageSteps = std::stoul(argv[++i]);
+        else if (argument == "--nearest" && i + 1 < argc) nearestFilename = argv[++i];
+        else if (argument == "--out-of-core" && i + 1 < argc) outOfCoreOptions.tileDirectory = argv[++i];
+        else if (argument == "--profile") profile = true;
+        else filenames.push_back(argument);
+    }
 
-    // the user can pick the file to read the input points from
-    // for the boundary
-    std::string filename;
-    std::cout << "Enter the geojson file route for the boundary: ";
-    std::cin >> filename;
+    // the computation stops if it takes more than the timeout, in every mode but the worker processes, which can't be
+    // stopped halfway
+    if (timeout > 0 && tiled && processes > 0 && outOfCoreOptions.tileDirectory.empty()) {
+        std::cerr << "--timeout can't be used with --processes" << std::endl;
+        return 1;
+    }
+    // the timeout starts when the computation does (after the points are read, or asked), every mode gets the token
+    auto startTimeout = [&]() {
+        if (timeout <= 0) return;
+        cancellation.setDeadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout)));
+        options.cancellation = &cancellation;
+        tiledOptions.cancellation = &cancellation;
+        outOfCoreOptions.cancellation = &cancellation;
+    };
 
-    // using nlohmann json library to read the input points from a json file
-    using json = nlohmann::json;
+    // the out of core mode reads the geojson files twice and never keeps all the points in memory
+    if (!outOfCoreOptions.tileDirectory.empty()) {
+        if (filenames.size() != 2) {
+            std::cerr << "--out-of-core needs the boundary and sites geojson files as arguments" << std::endl;
+            return 1;
+        }
+        if (tiledOptions.tilesPerSide != 0) outOfCoreOptions.tilesPerSide = tiledOptions.tilesPerSide;
+        outOfCoreOptions.topK = options.topK;
+        outOfCoreOptions.threads = options.threads;
+        // the out of core mode reads the points while it computes, so they count in its timeout
+        startTimeout();
+        OutOfCoreLargestEmptyCircle result;
+        try {
+            result = getOutOfCoreLargestEmptyCircle([&filenames](const std::function<void(const Point_2&)>& callback) { forEachInputPoint(filenames[0], filenames[1], callback); }, outOfCoreOptions);
+        } catch (const OperationCancelled& cancelled) {
+            std::cerr << "The largest empty circle was not computed: " << cancelled.what() << std::endl;
+            return 2;
+        } catch (const std::runtime_error& error) {
+            std::cerr << "Could not compute the largest empty circle out of core: " << error.what() << std::endl;
+            return 1;
+        }
+        std::cerr << result.numberOfSites << " sites in " << result.tiles << " tiles (" << result.numberOfRepresentatives << " representatives): "
+                  << result.loadedTiles << " tiles solved, " << result.skippedTiles << " skipped by their bound" << std::endl;
+        for (std::size_t i = 0; i < result.circles.size(); i++) {
+            std::cout << (i == 0 ? std::string("Largest empty circle") : "Circle " + std::to_string(i + 1)) << ": " << "Longitude: " << CGAL::to_double(result.circles[i].center.x()) << " Latitude: " << CGAL::to_double(result.circles[i].center.y()) << " Radius: " << result.circles[i].radius() << '\n';
+        }
+        return 0;
+    }
 
-    // the file is opened
-    std::ifstream file(filename);
-    // the file is parsed
-    json j;
-    file >> j;
-    // the file is closed
-    file.close();
+    // read from readInputPointsFrom() to read the input points from a geojson file
+    std::vector<Point_2> pointVertices;
+    try {
+        pointVertices = filenames.size() == 2 ? readInputPoints(filenames[0], filenames[1]) : readInputPointsFrom();
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Could not read the input points: " << error.what() << std::endl;
+        return 1;
+    }
+    startTimeout();
 
-    // for all coordinates in the file
-    for (size_t i = 0; i < j["features"][0]["geometry"]["coordinates"][0].size(); i++) {
-        // the x and y coordinates are extracted
-        float x = j["features"][0]["geometry"]["coordinates"][0][i][0];
-        float y = j["features"][0]["geometry"]["coordinates"][0][i][1];
-        // the position is added to the cgal points vector
-        pointsCGAL.push_back(Point_2(x, y));
+    // the tiles can also be solved by worker processes
+    if (tiled && processes > 0) {
+        ShardedOptions shardedOptions;
+        shardedOptions.processes = processes;
+        shardedOptions.tilesPerSide = tiledOptions.tilesPerSide;
+        shardedOptions.topK = options.topK;
+        // every worker solves its tiles in one thread, the processes take the place of the threads
+        if (options.threads != LargestEmptyCircleOptions().threads) std::cerr << "--threads is ignored with --processes" << std::endl;
+        ShardedLargestEmptyCircle result;
+        try {
+            result = getShardedLargestEmptyCircle(pointVertices, shardedOptions);
+        } catch (const std::runtime_error& error) {
+            std::cerr << "Could not start the workers: " << error.what() << std::endl;
+            return 1;
+        }
+        std::cerr << result.tiles << " tiles on " << result.processes << " processes, " << result.haloExpansions << " halo expansions, " << result.crashes << " workers died" << std::endl;
+        if (result.failedTiles > 0 || result.circles.empty()) {
+            std::cerr << result.failedTiles << " tiles could not be solved" << std::endl;
+            return 1;
+        }
+        std::cout << "Center of the largest empty circle: " << "Longitude: " << CGAL::to_double(result.circles[0].center.x()) << " Latitude: " << CGAL::to_double(result.circles[0].center.y()) << '\n';
+        std::cout << "Radius of the largest empty circle: " << result.circles[0].radius() << '\n';
+        // the next biggest circles if more than one was asked
+        for (std::size_t i = 1; i < result.circles.size(); i++) {
+            std::cout << "Circle " << i + 1 << ": " << "Longitude: " << CGAL::to_double(result.circles[i].center.x()) << " Latitude: " << CGAL::to_double(result.circles[i].center.y()) << " Radius: " << result.circles[i].radius() << '\n';
+        }
+        return 0;
     }
 
-    // for the points inside the boundary
-    std::cout << "Enter the geojson file route for the points inside the boundary: ";
-    std::cin >> filename;
-
-    // the file is opened
-    file.open(filename);
-    // the file is parsed
-    file >> j;
-    // the file is closed
-    file.close();
-
-    // for all features in the file
-    for (size_t i = 0; i < j["features"].size(); i++) {
-        // if ["geometry"]["type"] is "Polygon", only the first coordinates is considered
-        if (j["features"][i]["geometry"]["type"] == "Polygon") {
-            // for all coordinates in the file
-            float x = j["features"][i]["geometry"]["coordinates"][0][0][0];
-            float y = j["features"][i]["geometry"]["coordinates"][0][0][1];
+    // the tiled mode only gives the circle, without the tables of the stages
+    if (tiled) {
+        tiledOptions.threads = options.threads;
+        TiledLargestEmptyCircle result;
+        try {
+            result = getTiledLargestEmptyCircle(pointVertices, tiledOptions);
+        } catch (const OperationCancelled& cancelled) {
+            std::cerr << "The largest empty circle was not computed: " << cancelled.what() << std::endl;
+            return 2;
         }
-        // if ["geometry"]["type"] is "Point", the coordinates are extracted
-        else if (j["features"][i]["geometry"]["type"] == "Point") {
-            float x = j["features"][i]["geometry"]["coordinates"][0];
-            float y = j["features"][i]["geometry"]["coordinates"][1];
-            // the position is added to the cgal points vector
-            pointsCGAL.push_back(Point_2(x, y));
+        std::cerr << result.tiles << " tiles, " << result.haloExpansions << " halo expansions" << std::endl;
+        std::cout << "Center of the largest empty circle: " << "Longitude: " << CGAL::to_double(result.circle.center.x()) << " Latitude: " << CGAL::to_double(result.circle.center.y()) << '\n';
+        std::cout << "Radius of the largest empty circle: " << result.circle.radius() << '\n';
+        return 0;
+    }
+
+    // the processed data is obtained, the stages stop if they take more than the timeout
+    LargestEmptyCircleStages stages;
+    try {
+        runLargestEmptyCircleStages(pointVertices, snapshotDirectory, options, stages);
+    } catch (const OperationCancelled& cancelled) {
+        std::cerr << "The largest empty circle was not computed: " << cancelled.what() << std::endl;
+        return 2;
+    }
+    // a warm start doesn't run the stages, so its profile is empty
+    if (profile) printStageProfile(std::cerr, stages.profile);
+
+    // the covered fraction of the region for radii up to the radius of the circle is written as CSV instead of the circle
+    if (coverageSteps > 0) {
+        // a warm start doesn't restore the convex hull
+        if (stages.ch.size() == 0) stages.ch = getConvexHull(pointVertices);
+        CoverageCurve curve = getCoverageCurve(stages.dt2, stages.ch, getEvenlySpacedRadii(stages.circle.radius(), coverageSteps), options.threads);
+        std::cerr << "Area of the region: " << curve.regionArea << ", fully covered with radius " << curve.fullCoverageRadius << std::endl;
+        std::cout.precision(17);
+        std::cout << "radius,covered\n";
+        for (std::size_t i = 0; i < curve.radii.size(); i++) std::cout << curve.radii[i] << ',' << curve.coveredFractions[i] << '\n';
+        return 0;
+    }
+
+    // the nearest site of every query point is written as CSV instead of the circle
+    if (!nearestFilename.empty()) {
+        std::vector<Point_2> queries;
+        try {
+            forEachSitePoint(nearestFilename, [&queries](const Point_2& point) { queries.push_back(point); });
+        } catch (const std::runtime_error& error) {
+            std::cerr << "Could not read the query points: " << error.what() << std::endl;
+            return 1;
         }
+        auto start = std::chrono::steady_clock::now();
+        NearestSites nearestSites = findNearestSites(stages.dt2, queries, options.threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << queries.size() << " nearest sites in " << seconds << " s" << std::endl;
+        std::cout.precision(17);
+        std::cout << "query,site,distance\n";
+        for (std::size_t i = 0; i < queries.size(); i++) std::cout << i << ',' << nearestSites.siteIds[i] << ',' << nearestSites.distances[i] << '\n';
+        return 0;
     }
 
-    return pointsCGAL;
-}
+    // the results go to the geojson file if there is one (so the standard output can be the geojson itself)
+    if (!geojsonFilename.empty()) {
+        if (!writeGeojson(geojsonFilename, stages, withVoronoi, withCandidates)) {
+            std::cerr << "Could not write the geojson file " << geojsonFilename << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-int main(int, char**) {
-    // read from readInputPointsFrom() to read the input points from a geojson file
-    std::vector<Point_2> pointVertices = readInputPointsFrom();
-    // the processed data is obtained
-    getLargestEmptyCircle(pointVertices);
+    // the center of the largest empty circle is printed
+    std::cout << "Center of the largest empty circle: " << "Longitude: " << CGAL::to_double(stages.circle.center.x()) << " Latitude: " << CGAL::to_double(stages.circle.center.y()) << '\n';
+    // the radius of the largest empty circle is printed
+    std::cout << "Radius of the largest empty circle: " << stages.circle.radius() << '\n';
+    // the next biggest circles if more than one was asked
+    for (std::size_t i = 1; i < stages.topCircles.size(); i++) {
+        std::cout << "Circle " << i + 1 << ": " << "Longitude: " << CGAL::to_double(stages.topCircles[i].center.x()) << " Latitude: " << CGAL::to_double(stages.topCircles[i].center.y()) << " Radius: " << stages.topCircles[i].radius() << '\n';
+    }
     return 0;
-}
\ No newline at end of file
+}
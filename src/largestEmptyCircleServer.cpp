@@ -0,0 +1,468 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "coverageCurve.h"
+#include "datasetStore.h"
+#include "fileWatcher.h"
+#include "geojsonReader.h"
+#include "nearestSites.h"
+#include "polygonLargestEmptyCircle.h"
+#include "regionBatch.h"
+#include "resultCache.h"
+#include "siteEventLog.h"
+#include "siteLayer.h"
+#include "traceEvents.h"
+
+using json = nlohmann::json;
+
+// prints how to use the program
+void printUsage() {
+    std::cerr << "Usage: LargestEmptyCircleServer [--socket PATH] [--memory MB] [--threads N] [--cache N] [--data DATA_DIRECTORY] [--watch] [--trace FILE]" << std::endl;
+    std::cerr << "Keeps the triangulations of the datasets in memory and answers one JSON request per line on a Unix socket" << std::endl;
+    std::cerr << "(by default /tmp/largest-empty-circle.sock) with one JSON line:" << std::endl;
+    std::cerr << "  {\"op\": \"load\", \"dataset\": NAME, \"boundary\": FILE, \"sites\": FILE}" << std::endl;
+    std::cerr << "  {\"op\": \"lec\", \"dataset\": NAME}" << std::endl;
+    std::cerr << "  {\"op\": \"top\", \"dataset\": NAME, \"k\": K}" << std::endl;
+    std::cerr << "  {\"op\": \"polygon\", \"dataset\": NAME, \"polygon\": [[X, Y], ...], \"k\": K}" << std::endl;
+    std::cerr << "  {\"op\": \"coverage\", \"dataset\": NAME, \"radii\": [R, ...]} or with \"steps\": N" << std::endl;
+    std::cerr << "  {\"op\": \"nearest\", \"dataset\": NAME, \"points\": [[X, Y], ...]}" << std::endl;
+    std::cerr << "  {\"op\": \"insert\" or \"remove\", \"dataset\": NAME, \"points\": [[X, Y], ...]}" << std::endl;
+    std::cerr << "  {\"op\": \"follow\", \"dataset\": NAME, \"boundary\": FILE, \"sites\": FILE, \"log\": FILE, \"checkpoint\": FILE}" << std::endl;
+    std::cerr << "  {\"op\": \"drop\", \"dataset\": NAME} and {\"op\": \"list\"}" << std::endl;
+    std::cerr << "When the datasets use more than the memory budget (by default 1024 MB) the least recently used ones are" << std::endl;
+    std::cerr << "dropped. With --data the regions of the data directory are loaded by their name on their first query." << std::endl;
+    std::cerr << "The results of lec, top, polygon and coverage are cached (--cache N slots, by default 4096, 0 disables it)" << std::endl;
+    std::cerr << "by the content of the dataset and the parameters, so an insert or a remove makes them miss." << std::endl;
+    std::cerr << "An insert or a remove publishes a new version of the dataset, the queries running meanwhile finish with" << std::endl;
+    std::cerr << "the version they started with and are never blocked by the update." << std::endl;
+    std::cerr << "With --watch the sites files of the loaded datasets are watched, and when one changes only its features" << std::endl;
+    std::cerr << "that were added, deleted or moved (by their \"@id\" property) are updated in the triangulation." << std::endl;
+    std::cerr << "A followed dataset applies the open, move and close events appended to its log, and writes a checkpoint" << std::endl;
+    std::cerr << "every 100000 events, so following it again after a restart only replays the events after the checkpoint." << std::endl;
+    std::cerr << "SIGINT and SIGTERM stop the server, removing its socket. With --trace the spans of every request and stage" << std::endl;
+    std::cerr << "are written then as Chrome trace event JSON." << std::endl;
+}
+
+// the path of the socket, removed when the server is stopped
+std::string socketPath = "/tmp/largest-empty-circle.sock";
+
+// dataset whose sites file is watched (--watch)
+struct WatchedDataset {
+    std::string sitesFilename;
+    // the points of the boundary, they are sites too
+    std::vector<Point_2> boundary;
+    // the features of the sites file the last time the dataset was updated from it
+    SiteLayer layer;
+};
+
+// state shared by the connections
+struct Server {
+    std::unique_ptr<DatasetStore> store;
+    // the results of the queries, null if they aren't cached
+    std::unique_ptr<ResultCache> cache;
+    // the updates of the datasets are made one at a time, so none is lost
+    std::mutex updateMutex;
+    // threads used to load a dataset and to pick the top circles
+    std::size_t threads = 1;
+    // the regions of the data directory by name (--data), loaded on their first query
+    std::map<std::string, Region> regions;
+    // the watcher of the sites files and the watched datasets by name, null if the files aren't watched
+    std::unique_ptr<FileWatcher> watcher;
+    std::map<std::string, WatchedDataset> watched;
+    std::mutex watchedMutex;
+    // the consumers of the event logs of the followed datasets by name, polled by a thread of the server
+    std::map<std::string, std::unique_ptr<SiteEventConsumer>> followers;
+    std::mutex followersMutex;
+};
+
+// function that returns the circle as JSON
+json formatCircle(const LargestEmptyCircle& circle) {
+    return {{"center", {CGAL::to_double(circle.center.x()), CGAL::to_double(circle.center.y())}}, {"radius", circle.radius()}};
+}
+
+// function that loads a dataset from its files, if the files are watched the features of the sites file are kept to
+// compare them with the next version of the file
+std::shared_ptr<const Dataset> loadServerDataset(Server& server, const std::string& name, const std::string& boundaryFilename, const std::string& sitesFilename) {
+    if (!server.watcher) return loadDataset(name, boundaryFilename, sitesFilename, server.threads);
+    auto start = std::chrono::steady_clock::now();
+    WatchedDataset watched;
+    watched.sitesFilename = sitesFilename;
+    readBoundaryPoints(boundaryFilename, watched.boundary);
+    watched.layer = readSiteLayer(sitesFilename);
+    std::vector<Point_2> points = watched.boundary;
+    for (const auto& site : watched.layer.sites) points.push_back(site.second);
+    std::shared_ptr<Dataset> dataset = makeDataset(name, points, server.threads);
+    dataset->loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.watcher->watch(sitesFilename);
+    std::lock_guard<std::mutex> lock(server.watchedMutex);
+    server.watched[name] = std::move(watched);
+    return dataset;
+}
+
+// function called by the watcher when a sites file changed, every dataset loaded from it is updated with the features
+// that were added, deleted or moved since the last time, the rest of the triangulation is kept
+void reloadSites(Server& server, const std::string& sitesFilename) {
+    auto start = std::chrono::steady_clock::now();
+    SiteLayer layer;
+    try {
+        layer = readSiteLayer(sitesFilename);
+    } catch (const std::exception& exception) {
+        // the file may be half written, the next change reads it again
+        std::cerr << "Could not reload " << sitesFilename << ": " << exception.what() << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> updateLock(server.updateMutex);
+    std::lock_guard<std::mutex> watchedLock(server.watchedMutex);
+    for (auto& watched : server.watched) {
+        if (watched.second.sitesFilename != sitesFilename) continue;
+        SiteLayerDiff diff = diffSiteLayers(watched.second.layer, layer, watched.second.boundary);
+        // a dataset that was dropped is read again from the file when it's loaded
+        DatasetStore::Pin dataset = server.store->get(watched.first);
+        std::shared_ptr<const Dataset> updated;
+        try {
+            if (dataset && !diff.empty()) updated = updateDataset(*dataset, diff.inserted, diff.removed, server.threads);
+        } catch (const std::exception& exception) {
+            std::cerr << "Could not update " << watched.first << " from " << sitesFilename << ": " << exception.what() << std::endl;
+            continue;
+        }
+        if (updated) server.store->add(updated);
+        watched.second.layer = layer;
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Reloaded " << watched.first << " from " << sitesFilename << ": " << diff.addedFeatures << " added, " << diff.deletedFeatures << " deleted and " << diff.movedFeatures << " moved features in " << milliseconds << " ms";
+        if (updated) std::cerr << " (version " << updated->version << ")";
+        std::cerr << std::endl;
+    }
+}
+
+// function that applies the events appended to the logs of the followed datasets every some milliseconds, and
+// publishes the datasets that changed
+void followLogs(Server& server) {
+    // when the last error of every follower was printed, an error that repeats every poll is only printed every 10 s
+    std::map<std::string, std::chrono::steady_clock::time_point> lastErrors;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::lock_guard<std::mutex> updateLock(server.updateMutex);
+        std::lock_guard<std::mutex> followersLock(server.followersMutex);
+        for (auto& follower : server.followers) {
+            try {
+                std::size_t skippedLines = follower.second->skippedLines(), skippedEvents = follower.second->skippedEvents();
+                if (follower.second->poll() > 0) server.store->add(follower.second->dataset());
+                if (follower.second->skippedLines() > skippedLines) {
+                    std::cerr << "Skipped " << follower.second->skippedLines() - skippedLines << " malformed lines of the log of " << follower.first << ", the last one: " << follower.second->lastSkippedLine() << std::endl;
+                }
+                if (follower.second->skippedEvents() > skippedEvents) {
+                    std::cerr << "Skipped " << follower.second->skippedEvents() - skippedEvents << " events of the log of " << follower.first << " that couldn't be applied, the last one: " << follower.second->lastSkippedEvent() << std::endl;
+                }
+            } catch (const std::exception& exception) {
+                // the batch that failed is read again on the next poll
+                auto now = std::chrono::steady_clock::now();
+                auto lastError = lastErrors.find(follower.first);
+                if (lastError != lastErrors.end() && now - lastError->second < std::chrono::seconds(10)) continue;
+                lastErrors[follower.first] = now;
+                std::cerr << "Could not apply the events of " << follower.first << ": " << exception.what() << std::endl;
+            }
+        }
+    }
+}
+
+// function that throws std::runtime_error if the dataset follows a log, it only changes with its events (the follower
+// would publish its own version over any other update)
+void checkNotFollowed(Server& server, const std::string& name) {
+    std::lock_guard<std::mutex> lock(server.followersMutex);
+    if (server.followers.count(name)) throw std::runtime_error("the dataset " + name + " follows a log, append its events to the log (or drop it first)");
+}
+
+// function that pins the current version of the dataset of the request, loading it from the data directory if it's one
+// of its regions, throws std::runtime_error if it isn't loaded
+DatasetStore::Pin getRequestDataset(Server& server, const json& request) {
+    std::string name = request.at("dataset").get<std::string>();
+    DatasetStore::Pin dataset = server.store->get(name);
+    if (dataset) return dataset;
+    auto region = server.regions.find(name);
+    if (region == server.regions.end()) throw std::runtime_error("the dataset " + name + " is not loaded");
+    server.store->add(loadServerDataset(server, name, region->second.boundaryFilename, region->second.sitesFilename));
+    dataset = server.store->get(name);
+    if (!dataset) throw std::runtime_error("the dataset " + name + " was dropped right after it was loaded");
+    return dataset;
+}
+
+// function that answers a query over a dataset, returns false if the op is not a query
+bool answerQuery(Server& server, const std::string& op, const json& request, const Dataset& dataset, json& response) {
+    if (op == "lec") {
+        response = formatCircle(dataset.stages.circle);
+    } else if (op == "top") {
+        std::size_t k = request.value("k", std::size_t(1));
+        response["circles"] = json::array();
+        for (const LargestEmptyCircle& circle : getTopCircles(dataset, k, server.threads)) response["circles"].push_back(formatCircle(circle));
+    } else if (op == "polygon") {
+        // the circles centered inside the polygon, only the cells of the triangulation that touch it are visited
+        std::vector<Point_2> vertices;
+        for (const json& point : request.at("polygon")) vertices.push_back(Point_2(point.at(0).get<double>(), point.at(1).get<double>()));
+        // a closed ring (like the ones of GeoJSON) repeats its first vertex at the end
+        if (vertices.size() > 1 && vertices.front() == vertices.back()) vertices.pop_back();
+        Polygon_2 polygon(vertices.begin(), vertices.end());
+        PolygonLargestEmptyCircle query = getPolygonLargestEmptyCircle(dataset.stages.dt2, polygon, request.value("k", std::size_t(1)), getNearestVertex(dataset, vertices.empty() ? Point_2(0, 0) : vertices.front()));
+        response["circles"] = json::array();
+        for (const LargestEmptyCircle& circle : query.circles) response["circles"].push_back(formatCircle(circle));
+        response["visitedSites"] = query.visitedSites;
+        response["candidates"] = query.candidates;
+    } else if (op == "coverage") {
+        // the given radii, or steps radii up to the radius of the largest empty circle
+        std::vector<double> radii;
+        if (request.contains("radii")) radii = request.at("radii").get<std::vector<double>>();
+        else radii = getEvenlySpacedRadii(dataset.stages.circle.radius(), request.value("steps", std::size_t(10)));
+        CoverageCurve curve = getCoverageCurve(dataset.stages.dt2, dataset.stages.ch, radii, server.threads);
+        response["radii"] = curve.radii;
+        response["covered"] = curve.coveredFractions;
+        response["area"] = curve.regionArea;
+        response["fullCoverageRadius"] = curve.fullCoverageRadius;
+    } else if (op == "nearest") {
+        std::vector<Point_2> points;
+        for (const json& point : request.at("points")) points.push_back(Point_2(point.at(0).get<double>(), point.at(1).get<double>()));
+        // the walk of every chunk of queries starts from the grid of hints of the dataset
+        NearestSites nearestSites = findNearestSites(dataset.stages.dt2, points, server.threads, [&dataset](const Point_2& point) { return getNearestVertex(dataset, point); });
+        response["ids"] = nearestSites.siteIds;
+        response["distances"] = nearestSites.distances;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// function that answers a request, the errors are returned in the "error" field
+json handleRequest(Server& server, const std::string& line) {
+    auto start = std::chrono::steady_clock::now();
+    json response;
+    try {
+        json request = json::parse(line);
+        std::string op = request.at("op").get<std::string>();
+        // the spans of the request and of the stages it runs are tagged with its dataset
+        TraceRegion traceRegion(request.value("dataset", std::string()));
+        TraceSpan span(op, "request");
+        if (op == "lec" || op == "top" || op == "polygon" || op == "coverage" || op == "nearest") {
+            // the query pins the version it started with, an update publishes the next one without waiting for it
+            DatasetStore::Pin dataset = getRequestDataset(server, request);
+            // the results that only depend on the dataset and the parameters are cached, the key uses the content of
+            // the dataset and not its name, so an update changes the key of all its results
+            // (the parameters are dumped with their keys sorted, so the same query always gives the same string)
+            bool cacheable = server.cache && op != "nearest";
+            std::string parameters, cached;
+            if (cacheable) {
+                json query = request;
+                query.erase("dataset");
+                parameters = query.dump();
+            }
+            if (cacheable && server.cache->find(dataset->contentHash, parameters, cached)) {
+                response = json::parse(cached);
+                response["cached"] = true;
+            } else {
+                answerQuery(server, op, request, *dataset, response);
+                if (cacheable) server.cache->store(dataset->contentHash, parameters, response.dump());
+            }
+            response["version"] = dataset->version;
+        } else if (op == "load") {
+            checkNotFollowed(server, request.at("dataset").get<std::string>());
+            std::shared_ptr<const Dataset> dataset = loadServerDataset(server, request.at("dataset").get<std::string>(), request.at("boundary").get<std::string>(), request.at("sites").get<std::string>());
+            server.store->add(dataset);
+            response["points"] = dataset->numberOfPoints;
+            response["version"] = dataset->version;
+            response["bytes"] = dataset->memoryBytes;
+            response["loadSeconds"] = dataset->loadSeconds;
+        } else if (op == "insert" || op == "remove") {
+            // the next version is built from the current one while the queries keep using it, and then published, the
+            // queries running on the previous version finish with it
+            std::lock_guard<std::mutex> lock(server.updateMutex);
+            checkNotFollowed(server, request.at("dataset").get<std::string>());
+            DatasetStore::Pin dataset = getRequestDataset(server, request);
+            std::vector<Point_2> points;
+            for (const json& point : request.at("points")) points.push_back(Point_2(point.at(0).get<double>(), point.at(1).get<double>()));
+            std::shared_ptr<const Dataset> updated = op == "insert" ? updateDataset(*dataset, points, {}, server.threads) : updateDataset(*dataset, {}, points, server.threads);
+            if (updated) server.store->add(updated);
+            const Dataset& current = updated ? *updated : *dataset;
+            response["points"] = current.numberOfPoints;
+            response["version"] = current.version;
+            response["changed"] = updated != nullptr;
+            if (updated) response["updateSeconds"] = updated->loadSeconds;
+        } else if (op == "follow") {
+            // the dataset is restored from the checkpoint of its log (or built from its files) and the events after it
+            // are replayed, then the thread of the followers applies the new ones
+            std::string name = request.at("dataset").get<std::string>();
+            SiteEventConsumer::Options options;
+            options.threads = server.threads;
+            std::unique_ptr<SiteEventConsumer> follower(new SiteEventConsumer(name, request.at("boundary").get<std::string>(), request.at("sites").get<std::string>(), request.at("log").get<std::string>(), request.at("checkpoint").get<std::string>(), options));
+            std::lock_guard<std::mutex> lock(server.followersMutex);
+            server.store->add(follower->dataset());
+            response["points"] = follower->dataset()->numberOfPoints;
+            response["restored"] = follower->restored();
+            response["replayedEvents"] = follower->replayedEvents();
+            response["offset"] = follower->offset();
+            response["recoverySeconds"] = follower->recoverySeconds();
+            response["skippedLines"] = follower->skippedLines();
+            response["skippedEvents"] = follower->skippedEvents();
+            server.followers[name] = std::move(follower);
+            {
+                // the sites file of a dataset loaded before doesn't update it anymore
+                std::lock_guard<std::mutex> watchedLock(server.watchedMutex);
+                server.watched.erase(name);
+            }
+        } else if (op == "drop") {
+            std::string name = request.at("dataset").get<std::string>();
+            {
+                // a dropped dataset stops following its log
+                std::lock_guard<std::mutex> lock(server.followersMutex);
+                server.followers.erase(name);
+            }
+            response["dropped"] = server.store->remove(name);
+        } else if (op == "list") {
+            response["datasets"] = json::array();
+            for (const DatasetStore::DatasetInfo& info : server.store->list()) {
+                response["datasets"].push_back({{"dataset", info.name}, {"version", info.version}, {"points", info.numberOfPoints}, {"bytes", info.memoryBytes}});
+            }
+            response["retiredVersions"] = server.store->retiredVersions();
+            response["memoryUsed"] = server.store->memoryUsed();
+            response["memoryBudget"] = server.store->memoryBudget();
+            response["evictions"] = server.store->evictions();
+            if (server.cache) response["cache"] = {{"slots", server.cache->slots()}, {"bytes", server.cache->bytes()}, {"hits", server.cache->hits()}, {"misses", server.cache->misses()}, {"stores", server.cache->stores()}};
+        } else {
+            throw std::runtime_error("unknown op " + op);
+        }
+    } catch (const std::exception& exception) {
+        response = json::object();
+        response["error"] = exception.what();
+    }
+    response["micros"] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return response;
+}
+
+// function that answers the requests of a connection until it's closed
+void serveConnection(Server& server, int connection) {
+    std::string buffer;
+    char bytes[4096];
+    while (true) {
+        ssize_t received = ::read(connection, bytes, sizeof(bytes));
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        buffer.append(bytes, static_cast<std::size_t>(received));
+        // every complete line is a request
+        std::size_t lineStart = 0, lineEnd;
+        bool open = true;
+        while (open && (lineEnd = buffer.find('\n', lineStart)) != std::string::npos) {
+            std::string line = buffer.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            std::string reply = handleRequest(server, line).dump() + '\n';
+            for (std::size_t sent = 0; sent < reply.size();) {
+                ssize_t written = ::write(connection, reply.data() + sent, reply.size() - sent);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) {
+                    open = false;
+                    break;
+                }
+                sent += static_cast<std::size_t>(written);
+            }
+        }
+        if (!open) break;
+        buffer.erase(0, lineStart);
+    }
+    ::close(connection);
+}
+
+int main(int argc, char** argv) {
+    // SIGINT and SIGTERM are blocked before any thread starts, so every thread inherits the mask and they are only
+    // received by the accept loop, through a signalfd polled with the listener
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    ::pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+    // the memory budget in MB and the data directory (--data), empty if the datasets are only loaded by requests
+    std::size_t memoryMegabytes = 1024;
+    std::size_t cacheSlots = 4096;
+    std::string dataDirectory;
+    bool watch = false;
+    Server server;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (argument == "--memory" && i + 1 < argc) memoryMegabytes = std::stoul(argv[++i]);
+        else if (argument == "--threads" && i + 1 < argc) server.threads = std::stoul(argv[++i]);
+        else if (argument == "--cache" && i + 1 < argc) cacheSlots = std::stoul(argv[++i]);
+        else if (argument == "--data" && i + 1 < argc) dataDirectory = argv[++i];
+        else if (argument == "--watch") watch = true;
+        else if (argument == "--trace" && i + 1 < argc) startTrace(argv[++i]);
+        else {
+            printUsage();
+            return argument == "--help" ? 0 : 1;
+        }
+    }
+    server.store.reset(new DatasetStore(memoryMegabytes << 20));
+    if (cacheSlots > 0) server.cache.reset(new ResultCache(cacheSlots));
+    if (watch) server.watcher.reset(new FileWatcher([&server](const std::string& filename) { reloadSites(server, filename); }));
+    std::thread(followLogs, std::ref(server)).detach();
+    if (!dataDirectory.empty()) {
+        for (const Region& region : discoverRegions(dataDirectory)) server.regions[region.name] = region;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "The socket path is too long: " << socketPath << std::endl;
+        return 1;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // a socket left by a server that didn't stop cleanly is replaced
+    ::unlink(socketPath.c_str());
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+        std::cerr << "Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    int stopFd = ::signalfd(-1, &stopSignals, SFD_CLOEXEC);
+    if (stopFd < 0) {
+        std::cerr << "Could not wait for the signals: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    // a client that leaves before its reply must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cerr << "Listening on " << socketPath << " with " << memoryMegabytes << " MB for the datasets" << std::endl;
+
+    // every connection has its own thread, the datasets are shared and only read by the queries
+    pollfd waited[2] = {{listener, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    while (true) {
+        if (::poll(waited, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Could not wait for a connection: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (waited[1].revents & POLLIN) break;
+        if (!(waited[0].revents & POLLIN)) continue;
+        int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Could not accept a connection: " << std::strerror(errno) << std::endl;
+            continue;
+        }
+        std::thread(serveConnection, std::ref(server), connection).detach();
+    }
+
+    // the socket is removed and the trace written (with --trace), the connections still open are cut by leaving without waiting for
+    // them
+    ::unlink(socketPath.c_str());
+    writeTrace();
+    _exit(0);
+}
@@ -0,0 +1,59 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// read only memory mapping of a whole file, the mapping is released when the object is destroyed
+class MappedFile {
+public:
+    MappedFile() {}
+
+    // constructor that maps the file, isOpen() tells if it worked
+    explicit MappedFile(const std::string& filename) { open(filename); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { close(); }
+
+    // maps the file, returns false if it can't be opened or mapped
+    bool open(const std::string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the descriptor is not needed once the file is mapped
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+        m_data = static_cast<const char*>(mapping);
+        m_size = static_cast<std::size_t>(st.st_size);
+        return true;
+    }
+
+    // unmaps the file
+    void close() {
+        if (m_data) munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool isOpen() const { return m_data != nullptr; }
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+#endif
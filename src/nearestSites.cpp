@@ -0,0 +1,33 @@
+#include "nearestSites.h"
+#include "threadPool.h"
+#include <cmath>
+#include <numeric>
+#include <CGAL/hilbert_sort.h>
+
+// function that finds the nearest site of every query point: the queries are sorted along a Hilbert curve, so
+// consecutive queries are close and every walk starts from the answer of the previous one, and the sorted queries are
+// split in chunks of kCandidateChunkSize solved by threads threads (0 is one per hardware thread), the first walk of a
+// chunk starts from getHint (if given, like the grid of hints of a resident dataset) or from any site
+NearestSites findNearestSites(const Delaunay_triangulation_2& dt2, const std::vector<Point_2>& queries, std::size_t threads, const NearestSiteHint& getHint) {
+    NearestSites nearestSites;
+    nearestSites.siteIds.resize(queries.size());
+    nearestSites.distances.resize(queries.size());
+    if (queries.empty() || dt2.number_of_vertices() == 0) return nearestSites;
+
+    // the order of the queries along the curve, the results are written back in the order of the queries
+    std::vector<std::size_t> order(queries.size());
+    std::iota(order.begin(), order.end(), 0);
+    CGAL::hilbert_sort(order.begin(), order.end(), Spatial_sort_traits_2(CGAL::make_property_map(queries)));
+
+    parallelFor(order.size(), kCandidateChunkSize, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+        Delaunay_triangulation_2::Vertex_handle hint;
+        if (getHint) hint = getHint(queries[order[begin]]);
+        for (std::size_t i = begin; i < end; i++) {
+            const Point_2& query = queries[order[i]];
+            hint = walkToNearestVertex(dt2, query, hint);
+            nearestSites.siteIds[order[i]] = hint->info();
+            nearestSites.distances[order[i]] = std::sqrt(CGAL::to_double(CGAL::squared_distance(query, hint->point())));
+        }
+    });
+    return nearestSites;
+}
@@ -0,0 +1,26 @@
+#ifndef NEAREST_SITES_H
+#define NEAREST_SITES_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// columnar result of a batch of nearest site queries, the entry i of every column belongs to the query point i
+struct NearestSites {
+    // the id of the nearest site (its position in the input points)
+    std::vector<SiteId> siteIds;
+    // the distance to the nearest site
+    std::vector<double> distances;
+};
+
+// function that returns the vertex where the walk of a query point starts
+typedef std::function<Delaunay_triangulation_2::Vertex_handle(const Point_2&)> NearestSiteHint;
+
+// function that finds the nearest site of every query point: the queries are sorted along a Hilbert curve, so
+// consecutive queries are close and every walk starts from the answer of the previous one, and the sorted queries are
+// split in chunks of kCandidateChunkSize solved by threads threads (0 is one per hardware thread), the first walk of a
+// chunk starts from getHint (if given, like the grid of hints of a resident dataset) or from any site
+NearestSites findNearestSites(const Delaunay_triangulation_2& dt2, const std::vector<Point_2>& queries, std::size_t threads = 1, const NearestSiteHint& getHint = NearestSiteHint());
+
+#endif
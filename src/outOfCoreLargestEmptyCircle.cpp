@@ -0,0 +1,204 @@
+#include "outOfCoreLargestEmptyCircle.h"
+#include "mappedFile.h"
+#include "tiledLargestEmptyCircle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// number of points of a tile kept in memory before they are appended to the file of the tile
+const std::size_t kTileBufferPoints = 4096;
+
+// writer of the tile files, every tile has a small buffer that is appended to its file when it's full, so only one
+// file is open at a time
+class TileFileWriter {
+public:
+    TileFileWriter(const std::string& directory, std::size_t tiles) : m_directory(directory), m_buffers(tiles) {}
+
+    // adds a site to the buffer of its tile
+    void add(std::size_t tile, const Point_2& site) {
+        std::vector<double>& buffer = m_buffers[tile];
+        buffer.push_back(CGAL::to_double(site.x()));
+        buffer.push_back(CGAL::to_double(site.y()));
+        if (buffer.size() >= 2 * kTileBufferPoints) flush(tile);
+    }
+
+    // appends the buffer of every tile to its file
+    void flushAll() {
+        for (std::size_t tile = 0; tile < m_buffers.size(); tile++) flush(tile);
+    }
+
+private:
+    // appends the buffer of the tile to its file
+    void flush(std::size_t tile) {
+        std::vector<double>& buffer = m_buffers[tile];
+        if (buffer.empty()) return;
+        std::string filename = getTileFilename(m_directory, tile);
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(double));
+        if (!file) throw std::runtime_error("could not write the tile file " + filename);
+        buffer.clear();
+    }
+
+    std::string m_directory;
+    std::vector<std::vector<double>> m_buffers;
+};
+
+// removes the files of the tiles when it's destroyed, so they are removed even if the computation throws
+class TileFilesRemover {
+public:
+    TileFilesRemover(const std::string& directory, std::size_t tiles) : m_directory(directory), m_tiles(tiles) {}
+    ~TileFilesRemover() {
+        for (std::size_t tile = 0; tile < m_tiles; tile++) std::remove(getTileFilename(m_directory, tile).c_str());
+    }
+    TileFilesRemover(const TileFilesRemover&) = delete;
+    TileFilesRemover& operator=(const TileFilesRemover&) = delete;
+
+private:
+    std::string m_directory;
+    std::size_t m_tiles;
+};
+
+// function that adds the sites of the file of a tile inside the rectangle to sites
+void readTileSites(const std::string& filename, const Iso_rectangle_2& rectangle, std::vector<Point_2>& sites) {
+    // a tile without sites has no file
+    MappedFile file(filename);
+    if (!file.isOpen()) return;
+    const double* coordinates = reinterpret_cast<const double*>(file.data());
+    std::size_t numberOfSites = file.size() / (2 * sizeof(double));
+    double xmin = CGAL::to_double(rectangle.xmin()), ymin = CGAL::to_double(rectangle.ymin());
+    double xmax = CGAL::to_double(rectangle.xmax()), ymax = CGAL::to_double(rectangle.ymax());
+    for (std::size_t i = 0; i < numberOfSites; i++) {
+        double x = coordinates[2 * i], y = coordinates[2 * i + 1];
+        if (x >= xmin && x <= xmax && y >= ymin && y <= ymax) sites.push_back(Point_2(x, y));
+    }
+}
+
+}
+
+// function that returns the route of the file of a tile inside the tile directory
+std::string getTileFilename(const std::string& directory, std::size_t tile) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "tile-%06zu.bin", tile);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// function that returns the largest empty circles of the points of the source keeping in memory only the convex hull,
+// the representative sites and one tile with its halo at a time, throws std::runtime_error if the tile files
+// can't be written
+OutOfCoreLargestEmptyCircle getOutOfCoreLargestEmptyCircle(const PointSource& pointSource, const OutOfCoreOptions& options) {
+    OutOfCoreLargestEmptyCircle outOfCore;
+    std::size_t k = std::max<std::size_t>(1, options.topK);
+
+    // 1- first pass: the bounding box and the convex hull, the hull of a batch of points and the hull of the
+    // previous batches is the hull of all of them
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    std::vector<Point_2> hullPoints;
+    std::size_t hullBatchSize = std::max<std::size_t>(3, options.hullBatchSize);
+    pointSource([&](const Point_2& point) {
+        double x = CGAL::to_double(point.x()), y = CGAL::to_double(point.y());
+        if (outOfCore.numberOfSites == 0) {
+            minX = maxX = x;
+            minY = maxY = y;
+        }
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        // the token is checked every batch of points, like the insertion of the triangulation
+        if (options.cancellation && outOfCore.numberOfSites % kTriangulationBatchSize == 0) options.cancellation->check();
+        outOfCore.numberOfSites++;
+        hullPoints.push_back(point);
+        if (hullPoints.size() >= hullBatchSize) {
+            Polygon_2 ch = getConvexHull(hullPoints);
+            hullPoints.assign(ch.vertices_begin(), ch.vertices_end());
+            // a batch of points on a line keeps only the ends, so the next batch is never empty
+            hullBatchSize = std::max(hullBatchSize, 2 * hullPoints.size());
+        }
+    });
+    if (outOfCore.numberOfSites == 0) return outOfCore;
+    Polygon_2 ch = getConvexHull(hullPoints);
+    std::vector<Segment_2> chSegments = getPolygonSegments(ch);
+    hullPoints.clear();
+    hullPoints.shrink_to_fit();
+
+    // 2- second pass: the sites go to the files of their tiles, and the first site of every cell of the grid of
+    // representatives of a tile is kept
+    TileGrid tileGrid = makeTileGrid(minX, minY, maxX, maxY, options.tilesPerSide);
+    outOfCore.tiles = tileGrid.size();
+    std::filesystem::create_directories(options.tileDirectory);
+    // the files left by a previous run are removed, and the ones of this run when it ends (or throws)
+    for (std::size_t tile = 0; tile < tileGrid.size(); tile++) std::remove(getTileFilename(options.tileDirectory, tile).c_str());
+    TileFilesRemover tileFilesRemover(options.tileDirectory, tileGrid.size());
+    std::size_t representativesPerSide = std::max<std::size_t>(1, options.representativesPerSide);
+    TileGrid representativeGrid = makeTileGrid(minX, minY, maxX, maxY, tileGrid.tilesPerSide * representativesPerSide);
+    std::vector<bool> representedCells(representativeGrid.size(), false);
+    std::vector<Point_2> representatives;
+    {
+        TileFileWriter writer(options.tileDirectory, tileGrid.size());
+        std::size_t written = 0;
+        pointSource([&](const Point_2& point) {
+            if (options.cancellation && written++ % kTriangulationBatchSize == 0) options.cancellation->check();
+            writer.add(tileGrid.getTileIndex(point), point);
+            std::size_t cell = representativeGrid.getTileIndex(point);
+            if (!representedCells[cell]) {
+                representedCells[cell] = true;
+                representatives.push_back(point);
+            }
+        });
+        writer.flushAll();
+    }
+    outOfCore.numberOfRepresentatives = representatives.size();
+
+    // 3- the bound of every tile is its largest empty circle among the representatives, which are few enough to
+    // be solved in memory (the bound is 0 for the tiles outside the convex hull)
+    double width = std::max(tileGrid.maxX - tileGrid.minX, tileGrid.tileWidth);
+    double height = std::max(tileGrid.maxY - tileGrid.minY, tileGrid.tileHeight);
+    double firstHalo = 2 * std::sqrt(width * height / representatives.size());
+    std::size_t haloExpansions = 0;
+    std::vector<TileResult> bounds = solveLargestEmptyCircleTiles(representatives, tileGrid, ch, chSegments, firstHalo, options.threads, haloExpansions, 1, options.cancellation);
+    representatives.clear();
+    representatives.shrink_to_fit();
+
+    // 4- the tiles from the biggest bound to the smallest, the tiles that can't beat the k-th best circle are skipped
+    std::vector<std::size_t> order(tileGrid.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&bounds](std::size_t a, std::size_t b) { return bounds[a].maxSquaredRadius > bounds[b].maxSquaredRadius; });
+    for (std::size_t tile : order) {
+        double bound = bounds[tile].maxSquaredRadius;
+        if (!(bound > 0)) continue;
+        if (options.cancellation) options.cancellation->check();
+        if (outOfCore.circles.size() == k && bound <= CGAL::to_double(outOfCore.circles.back().squaredRadius)) {
+            outOfCore.skippedTiles++;
+            continue;
+        }
+
+        // a halo as big as the bound has the nearest site of every point of the tile
+        Iso_rectangle_2 core = tileGrid.getTile(tile);
+        double halo = std::sqrt(bound);
+        TileResult result;
+        while (true) {
+            Iso_rectangle_2 expanded(CGAL::to_double(core.xmin()) - halo, CGAL::to_double(core.ymin()) - halo, CGAL::to_double(core.xmax()) + halo, CGAL::to_double(core.ymax()) + halo);
+            std::vector<Point_2> haloSites;
+            for (std::size_t row = tileGrid.getRow(CGAL::to_double(expanded.ymin())); row <= tileGrid.getRow(CGAL::to_double(expanded.ymax())); row++) {
+                for (std::size_t column = tileGrid.getColumn(CGAL::to_double(expanded.xmin())); column <= tileGrid.getColumn(CGAL::to_double(expanded.xmax())); column++) {
+                    readTileSites(getTileFilename(options.tileDirectory, row * tileGrid.tilesPerSide + column), expanded, haloSites);
+                }
+            }
+            result = solveLargestEmptyCircleTile(haloSites, core, ch, chSegments, k);
+            // the bound already makes the circles exact, the halo is only grown if a rounding made it too tight
+            bool covering = CGAL::to_double(expanded.xmin()) <= minX && CGAL::to_double(expanded.ymin()) <= minY && CGAL::to_double(expanded.xmax()) >= maxX && CGAL::to_double(expanded.ymax()) >= maxY;
+            if (covering || result.maxSquaredRadius <= halo * halo) break;
+            halo = std::max(2 * halo, std::sqrt(result.maxSquaredRadius));
+            if (std::isinf(halo)) halo = 2 * std::max(width, height);
+        }
+        outOfCore.loadedTiles++;
+        mergeLargestEmptyCircles(outOfCore.circles, result.circles, k);
+    }
+    return outOfCore;
+}
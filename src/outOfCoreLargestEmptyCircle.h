@@ -0,0 +1,62 @@
+#ifndef OUT_OF_CORE_LARGEST_EMPTY_CIRCLE_H
+#define OUT_OF_CORE_LARGEST_EMPTY_CIRCLE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// the out of core mode is for inputs whose triangulation doesn't fit in memory, it reads the input twice:
+// - the first pass finds the bounding box and the convex hull (keeping only the hull of the points seen so far)
+// - the second pass writes every site to the file of its tile and keeps a few representative sites per tile
+//   (the first site that falls in every cell of a small grid inside the tile)
+// the representative sites are a subset of the sites, so the distance from a point to its nearest representative
+// is an upper bound of the distance to its nearest site, and the largest of them over a tile bounds every circle
+// centered in the tile. The tiles are solved from the biggest bound to the smallest with the sites of the tile and
+// a halo as big as the bound (so the circles of the tile are exact), and a tile whose bound can't beat the k-th best
+// circle is skipped without reading its file
+
+// options of the out of core largest empty circle
+struct OutOfCoreOptions {
+    // directory for the tile files (they are removed at the end)
+    std::string tileDirectory;
+    // number of tiles on each side of the grid
+    std::size_t tilesPerSide = 32;
+    // number of cells on each side of the grid of representative sites of a tile
+    std::size_t representativesPerSide = 4;
+    // number of circles kept
+    std::size_t topK = 1;
+    // number of threads for the bounds of the tiles (0 is one per hardware thread)
+    std::size_t threads = 1;
+    // number of points read before the convex hull of the points seen so far is computed again
+    std::size_t hullBatchSize = 1 << 20;
+    // token checked between the passes, before every tile and every some points read (OperationCancelled is thrown
+    // when it stops the computation), null if the computation can't be cancelled
+    const CancellationToken* cancellation = nullptr;
+};
+
+// result of the out of core largest empty circle
+struct OutOfCoreLargestEmptyCircle {
+    // the k largest empty circles, from the biggest to the smallest
+    std::vector<LargestEmptyCircle> circles;
+    std::size_t numberOfSites = 0;
+    std::size_t numberOfRepresentatives = 0;
+    // number of tiles, of tiles that were read and solved and of tiles skipped by their bound
+    std::size_t tiles = 0;
+    std::size_t loadedTiles = 0;
+    std::size_t skippedTiles = 0;
+};
+
+// function that calls its callback with every input point, it's called once per pass over the input
+typedef std::function<void(const std::function<void(const Point_2&)>&)> PointSource;
+
+// function that returns the route of the file of a tile inside the tile directory
+std::string getTileFilename(const std::string& directory, std::size_t tile);
+
+// function that returns the largest empty circles of the points of the source keeping in memory only the convex hull,
+// the representative sites and one tile with its halo at a time, throws std::runtime_error if the tile files
+// can't be written
+OutOfCoreLargestEmptyCircle getOutOfCoreLargestEmptyCircle(const PointSource& pointSource, const OutOfCoreOptions& options);
+
+#endif
@@ -0,0 +1,129 @@
+#include "pointGenerators.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// points generated together by a thread
+const std::size_t kGeneratorChunkSize = 4096;
+// draws of every point, the counter of the draw d of the point i is i * kDrawsPerPoint + d
+const std::uint64_t kDrawsPerPoint = 4;
+// the draws of the things that aren't points (like the centers of the clusters) use counters from here on
+const std::uint64_t kSharedCounters = 1ull << 62;
+
+const double kPi = 3.14159265358979323846;
+
+}
+
+// 64 random bits of the counter
+std::uint64_t CounterRandom::bits(std::uint64_t counter) const {
+    // the seed and the counter mixed by the finalizer of splitmix64, twice so close seeds give unrelated numbers
+    std::uint64_t z = m_seed * 0x9e3779b97f4a7c15ull + counter;
+    for (int round = 0; round < 2; round++) {
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+    }
+    return z;
+}
+
+// function that returns n points of the distribution as x, y pairs (2 n numbers)
+std::vector<double> generatePoints(std::size_t n, const PointGeneratorOptions& options) {
+    CounterRandom random(options.seed);
+    double width = options.xmax - options.xmin, height = options.ymax - options.ymin;
+    double centerX = options.xmin + width / 2, centerY = options.ymin + height / 2;
+
+    // the centers of the clusters
+    std::size_t clusters = std::max<std::size_t>(1, options.clusters);
+    std::vector<double> clusterCenters(2 * clusters);
+    for (std::size_t c = 0; c < clusters; c++) {
+        clusterCenters[2 * c] = options.xmin + width * random.uniform(kSharedCounters + 2 * c);
+        clusterCenters[2 * c + 1] = options.ymin + height * random.uniform(kSharedCounters + 2 * c + 1);
+    }
+    // the side of the grid and the number of different points of the duplicates
+    std::size_t gridSide = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(n))));
+    std::size_t distinct = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(n * (1 - options.duplicateFraction))));
+
+    std::vector<double> points(2 * n);
+    parallelFor(n, kGeneratorChunkSize, options.threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t i = begin; i < end; i++) {
+            std::uint64_t counter = i * kDrawsPerPoint;
+            double u = random.uniform(counter), v = random.uniform(counter + 1);
+            double x = 0, y = 0;
+            switch (options.distribution) {
+            case PointDistribution::Uniform:
+                x = options.xmin + width * u;
+                y = options.ymin + height * v;
+                break;
+            case PointDistribution::Disk: {
+                // the radius is the square root of a uniform number, so the density is the same in the whole disk
+                double radius = std::sqrt(u), angle = 2 * kPi * v;
+                x = centerX + width / 2 * radius * std::cos(angle);
+                y = centerY + height / 2 * radius * std::sin(angle);
+                break;
+            }
+            case PointDistribution::Clustered: {
+                // a normal offset from Box-Muller around the center of a random cluster
+                std::size_t c = random.bits(counter + 2) % clusters;
+                double radius = std::sqrt(-2 * std::log(1 - u)), angle = 2 * kPi * v;
+                x = clusterCenters[2 * c] + options.clusterSpread * width * radius * std::cos(angle);
+                y = clusterCenters[2 * c + 1] + options.clusterSpread * height * radius * std::sin(angle);
+                break;
+            }
+            case PointDistribution::Grid:
+                x = options.xmin + width * static_cast<double>(i % gridSide) / std::max<std::size_t>(1, gridSide - 1);
+                y = options.ymin + height * static_cast<double>(i / gridSide) / std::max<std::size_t>(1, gridSide - 1);
+                break;
+            case PointDistribution::NearCollinear: {
+                // a point of the diagonal moved across it by at most the jitter
+                double offset = (2 * v - 1) * options.collinearJitter;
+                x = options.xmin + width * (u - offset);
+                y = options.ymin + height * (u + offset);
+                break;
+            }
+            case PointDistribution::Duplicates: {
+                // one of the different points, which are the uniform points of the first indices
+                std::uint64_t source = (random.bits(counter + 2) % distinct) * kDrawsPerPoint;
+                x = options.xmin + width * random.uniform(source);
+                y = options.ymin + height * random.uniform(source + 1);
+                break;
+            }
+            }
+            points[2 * i] = x;
+            points[2 * i + 1] = y;
+        }
+    });
+    return points;
+}
+
+// function that returns the name of the distribution ("uniform", "disk", "clustered", "grid", "near-collinear" or
+// "duplicates")
+std::string getPointDistributionName(PointDistribution distribution) {
+    switch (distribution) {
+    case PointDistribution::Uniform: return "uniform";
+    case PointDistribution::Disk: return "disk";
+    case PointDistribution::Clustered: return "clustered";
+    case PointDistribution::Grid: return "grid";
+    case PointDistribution::NearCollinear: return "near-collinear";
+    case PointDistribution::Duplicates: return "duplicates";
+    }
+    return "";
+}
+
+// function that reads the name of a distribution, returns false if it isn't one
+bool parsePointDistribution(const std::string& name, PointDistribution& distribution) {
+    for (PointDistribution candidate : getPointDistributions()) {
+        if (getPointDistributionName(candidate) == name) {
+            distribution = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// every distribution, in the order of the enum
+std::vector<PointDistribution> getPointDistributions() {
+    return {PointDistribution::Uniform, PointDistribution::Disk, PointDistribution::Clustered, PointDistribution::Grid, PointDistribution::NearCollinear, PointDistribution::Duplicates};
+}
@@ -0,0 +1,75 @@
+#ifndef POINT_GENERATORS_H
+#define POINT_GENERATORS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// generators of reproducible sets of points for the benchmarks, the differential tests and the Demo: every random
+// number is a hash of the seed, the index of the point and the number of the draw (a counter based generator), so
+// the points don't depend on the order they are generated in or on the number of threads, and the same options
+// always give the same points. The header doesn't use CGAL, the points are returned as x, y pairs
+
+// distributions of the points
+enum class PointDistribution {
+    // uniform in the box
+    Uniform,
+    // uniform in the disk inscribed in the box
+    Disk,
+    // a mixture of Gaussians around random centers
+    Clustered,
+    // the nodes of a regular grid, every cell has 4 cocircular points (the worst case of the in-circle predicate)
+    Grid,
+    // points on the diagonal of the box moved a tiny bit off it (the worst case of the orientation predicate)
+    NearCollinear,
+    // few different points, each one repeated many times
+    Duplicates
+};
+
+// options of the generators
+struct PointGeneratorOptions {
+    PointDistribution distribution = PointDistribution::Uniform;
+    std::uint64_t seed = 1;
+    // the box of the points
+    double xmin = 0, ymin = 0, xmax = 1, ymax = 1;
+    // Clustered: the number of Gaussians and their standard deviation as a fraction of the side of the box
+    std::size_t clusters = 16;
+    double clusterSpread = 0.02;
+    // NearCollinear: the biggest distance to the diagonal as a fraction of the side of the box
+    double collinearJitter = 1e-9;
+    // Duplicates: the fraction of the points that repeat another one
+    double duplicateFraction = 0.9;
+    // threads that generate the points (the points are the same with any number)
+    std::size_t threads = 1;
+};
+
+// counter based random numbers: the number of a counter is a hash of the seed and the counter, so any of them can be
+// computed without computing the previous ones
+class CounterRandom {
+public:
+    explicit CounterRandom(std::uint64_t seed) : m_seed(seed) {}
+
+    // 64 random bits of the counter
+    std::uint64_t bits(std::uint64_t counter) const;
+    // a random number in [0, 1) of the counter
+    double uniform(std::uint64_t counter) const { return static_cast<double>(bits(counter) >> 11) * 0x1.0p-53; }
+
+private:
+    std::uint64_t m_seed;
+};
+
+// function that returns n points of the distribution as x, y pairs (2 n numbers)
+std::vector<double> generatePoints(std::size_t n, const PointGeneratorOptions& options = PointGeneratorOptions());
+
+// function that returns the name of the distribution ("uniform", "disk", "clustered", "grid", "near-collinear" or
+// "duplicates")
+std::string getPointDistributionName(PointDistribution distribution);
+
+// function that reads the name of a distribution, returns false if it isn't one
+bool parsePointDistribution(const std::string& name, PointDistribution& distribution);
+
+// every distribution, in the order of the enum
+std::vector<PointDistribution> getPointDistributions();
+
+#endif
@@ -0,0 +1,239 @@
+#include "polygonLargestEmptyCircle.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// candidate point of the polygon query with a site near it, where the walk to its nearest site starts
+typedef std::pair<Point_2, Delaunay_triangulation_2::Vertex_handle> Candidate;
+
+// part of the line p + t * d with t in [t0, t1], in doubles, used to look up the polygon edges near a Voronoi edge
+struct ParametricLine {
+    double x, y, dx, dy, t0, t1;
+};
+
+// functions that return the parametric line of the segments, rays and lines of the Voronoi diagram
+ParametricLine getParametricLine(const Segment_2& s) {
+    double x = CGAL::to_double(s.source().x()), y = CGAL::to_double(s.source().y());
+    return ParametricLine{x, y, CGAL::to_double(s.target().x()) - x, CGAL::to_double(s.target().y()) - y, 0, 1};
+}
+
+ParametricLine getParametricLine(const Ray_2& r) {
+    K::Vector_2 d = r.to_vector();
+    return ParametricLine{CGAL::to_double(r.source().x()), CGAL::to_double(r.source().y()), CGAL::to_double(d.x()), CGAL::to_double(d.y()), 0, std::numeric_limits<double>::infinity()};
+}
+
+ParametricLine getParametricLine(const Line_2& l) {
+    Point_2 p = l.point(0);
+    K::Vector_2 d = l.to_vector();
+    double infinity = std::numeric_limits<double>::infinity();
+    return ParametricLine{CGAL::to_double(p.x()), CGAL::to_double(p.y()), CGAL::to_double(d.x()), CGAL::to_double(d.y()), -infinity, infinity};
+}
+
+// uniform grid over the bounding box of the polygon where every cell has the edges whose bounding box overlaps it, so a
+// Voronoi edge is only intersected with the polygon edges near it instead of with all of them, the boxes are widened by
+// a small margin so the rounding to doubles never drops an edge that the exact intersection would find
+class PolygonSegmentIndex {
+public:
+    explicit PolygonSegmentIndex(const std::vector<Segment_2>& segments) : m_stamps(segments.size(), 0) {
+        m_minX = m_minY = std::numeric_limits<double>::infinity();
+        m_maxX = m_maxY = -std::numeric_limits<double>::infinity();
+        std::vector<double> boxes;
+        boxes.reserve(4 * segments.size());
+        for (const Segment_2& segment : segments) {
+            double x0 = CGAL::to_double(segment.source().x()), y0 = CGAL::to_double(segment.source().y());
+            double x1 = CGAL::to_double(segment.target().x()), y1 = CGAL::to_double(segment.target().y());
+            boxes.insert(boxes.end(), {std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1)});
+            m_minX = std::min(m_minX, boxes[boxes.size() - 4]);
+            m_minY = std::min(m_minY, boxes[boxes.size() - 3]);
+            m_maxX = std::max(m_maxX, boxes[boxes.size() - 2]);
+            m_maxY = std::max(m_maxY, boxes[boxes.size() - 1]);
+        }
+        double size = std::max({m_maxX - m_minX, m_maxY - m_minY, std::abs(m_minX), std::abs(m_minY), std::abs(m_maxX), std::abs(m_maxY)});
+        m_margin = std::max(size * 1e-9, std::numeric_limits<double>::min());
+        m_minX -= m_margin;
+        m_minY -= m_margin;
+        m_maxX += m_margin;
+        m_maxY += m_margin;
+
+        // about one edge per cell
+        m_side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(segments.size()))));
+        m_cellWidth = (m_maxX - m_minX) / m_side;
+        m_cellHeight = (m_maxY - m_minY) / m_side;
+        m_cells.resize(m_side * m_side);
+        for (std::size_t i = 0; i < segments.size(); i++) {
+            addToCells(boxes[4 * i] - m_margin, boxes[4 * i + 1] - m_margin, boxes[4 * i + 2] + m_margin, boxes[4 * i + 3] + m_margin, i);
+        }
+    }
+
+    // function that returns the indices of the polygon edges whose bounding box overlaps the part of the line inside the
+    // bounding box of the polygon, the edges that can't cross it are left out
+    const std::vector<std::size_t>& query(const ParametricLine& line) {
+        m_found.clear();
+        double t0 = line.t0, t1 = line.t1;
+
+        // Liang-Barsky clipping of the line against the bounding box of the polygon
+        const double p[4] = {-line.dx, line.dx, -line.dy, line.dy};
+        const double q[4] = {line.x - m_minX, m_maxX - line.x, line.y - m_minY, m_maxY - line.y};
+        for (int i = 0; i < 4; i++) {
+            if (p[i] == 0) {
+                if (q[i] < 0) return m_found;
+                continue;
+            }
+            double t = q[i] / p[i];
+            if (p[i] < 0) t0 = std::max(t0, t);
+            else t1 = std::min(t1, t);
+        }
+        if (t0 > t1) return m_found;
+
+        // a zero direction leaves the parameters of a segment as they were, the line is then a point
+        double x0 = line.x + (line.dx == 0 ? 0 : t0 * line.dx), y0 = line.y + (line.dy == 0 ? 0 : t0 * line.dy);
+        double x1 = line.x + (line.dx == 0 ? 0 : t1 * line.dx), y1 = line.y + (line.dy == 0 ? 0 : t1 * line.dy);
+        m_query++;
+        forEachCell(std::min(x0, x1) - m_margin, std::min(y0, y1) - m_margin, std::max(x0, x1) + m_margin, std::max(y0, y1) + m_margin, [this](std::vector<std::size_t>& cell) {
+            for (std::size_t i : cell) {
+                if (m_stamps[i] == m_query) continue;
+                m_stamps[i] = m_query;
+                m_found.push_back(i);
+            }
+        });
+        return m_found;
+    }
+
+private:
+    // function that returns the cell of a coordinate along one axis, clamped to the grid
+    std::size_t getCell(double value, double min, double cellSize) const {
+        if (!(cellSize > 0)) return 0;
+        double cell = std::floor((value - min) / cellSize);
+        if (!(cell > 0)) return 0;
+        return std::min(m_side - 1, static_cast<std::size_t>(std::min(cell, static_cast<double>(m_side - 1))));
+    }
+
+    // function that calls f with every cell that overlaps the box
+    template <class F>
+    void forEachCell(double minX, double minY, double maxX, double maxY, F f) {
+        std::size_t i0 = getCell(minX, m_minX, m_cellWidth), i1 = getCell(maxX, m_minX, m_cellWidth);
+        std::size_t j0 = getCell(minY, m_minY, m_cellHeight), j1 = getCell(maxY, m_minY, m_cellHeight);
+        for (std::size_t j = j0; j <= j1; j++) {
+            for (std::size_t i = i0; i <= i1; i++) f(m_cells[j * m_side + i]);
+        }
+    }
+
+    void addToCells(double minX, double minY, double maxX, double maxY, std::size_t segment) {
+        forEachCell(minX, minY, maxX, maxY, [segment](std::vector<std::size_t>& cell) { cell.push_back(segment); });
+    }
+
+    double m_minX, m_minY, m_maxX, m_maxY, m_margin, m_cellWidth, m_cellHeight;
+    std::size_t m_side;
+    std::vector<std::vector<std::size_t>> m_cells;
+    // the query that last found every edge, so an edge in several cells is returned once
+    std::vector<std::size_t> m_stamps;
+    std::size_t m_query = 0;
+    std::vector<std::size_t> m_found;
+};
+
+// this template allows to use the same function for the segments, rays and lines of the Voronoi diagram
+// function that adds the crossings of the Voronoi edge with the edges of the polygon to the candidates, returns true if
+// the Voronoi edge crosses the polygon, only the edges the index finds near the Voronoi edge are intersected
+template <class RSL>
+bool addCrossings(const RSL& rsl, const std::vector<Segment_2>& polygonSegments, PolygonSegmentIndex& index, Delaunay_triangulation_2::Vertex_handle site, std::vector<Candidate>& candidates) {
+    bool crosses = false;
+    for (std::size_t i : index.query(getParametricLine(rsl))) {
+        // the intersection is stored in obj which supports multiple types
+        CGAL::Object obj = CGAL::intersection(polygonSegments[i], rsl);
+        if (const Point_2* p = CGAL::object_cast<Point_2>(&obj)) {
+            candidates.emplace_back(*p, site);
+            crosses = true;
+        } else if (const Segment_2* s = CGAL::object_cast<Segment_2>(&obj)) {
+            // an edge of the polygon over the Voronoi edge, its ends are the candidates
+            candidates.emplace_back(s->source(), site);
+            candidates.emplace_back(s->target(), site);
+            crosses = true;
+        }
+    }
+    return crosses;
+}
+}
+
+// function that returns the k largest empty circles of the sites of the triangulation whose center is inside the
+// polygon, the walk starts from the hint (or from any site if it's null), throws std::runtime_error if the polygon is
+// not simple or the triangulation has less than 3 sites
+PolygonLargestEmptyCircle getPolygonLargestEmptyCircle(const Delaunay_triangulation_2& dt2, const Polygon_2& polygon, std::size_t k, Delaunay_triangulation_2::Vertex_handle hint) {
+    if (dt2.number_of_vertices() < 3 || dt2.dimension() < 2) throw std::runtime_error("at least 3 sites not on a line are needed");
+    if (polygon.size() < 3 || !polygon.is_simple()) throw std::runtime_error("the polygon must be simple and have at least 3 vertices");
+    PolygonLargestEmptyCircle result;
+    std::vector<Segment_2> polygonSegments = getPolygonSegments(polygon);
+    PolygonSegmentIndex index(polygonSegments);
+    auto isInside = [&polygon](const Point_2& point) { return !polygon.has_on_unbounded_side(point); };
+
+    // the vertices of the polygon are candidates, and the cell of the first one is where the walk starts
+    std::vector<Candidate> candidates;
+    Delaunay_triangulation_2::Vertex_handle start = walkToNearestVertex(dt2, *polygon.vertices_begin(), hint);
+    for (auto vertex = polygon.vertices_begin(); vertex != polygon.vertices_end(); ++vertex) candidates.emplace_back(*vertex, start);
+
+    // the sites whose cell touches the polygon, the ones already expanded have handled all their Voronoi edges
+    std::set<Point_2> found, expanded;
+    std::vector<Delaunay_triangulation_2::Vertex_handle> pending(1, start);
+    found.insert(start->point());
+    while (!pending.empty()) {
+        Delaunay_triangulation_2::Vertex_handle v = pending.back();
+        pending.pop_back();
+        expanded.insert(v->point());
+        result.visitedSites++;
+
+        // the Voronoi vertices of the cell inside the polygon
+        Delaunay_triangulation_2::Face_circulator face = dt2.incident_faces(v), doneFaces = face;
+        if (face != nullptr) {
+            do {
+                if (dt2.is_infinite(face)) continue;
+                Point_2 voronoiVertex = dt2.circumcenter(face);
+                if (isInside(voronoiVertex)) candidates.emplace_back(voronoiVertex, v);
+            } while (++face != doneFaces);
+        }
+
+        // the Voronoi edges of the cell, a neighbor is visited if their shared edge touches the polygon
+        Delaunay_triangulation_2::Edge_circulator edge = dt2.incident_edges(v), doneEdges = edge;
+        if (edge == nullptr) continue;
+        do {
+            Delaunay_triangulation_2::Face_handle f = edge->first;
+            int i = edge->second;
+            Delaunay_triangulation_2::Vertex_handle neighbor = f->vertex(dt2.cw(i));
+            if (neighbor == v) neighbor = f->vertex(dt2.ccw(i));
+            if (dt2.is_infinite(neighbor) || expanded.count(neighbor->point()) > 0) continue;
+
+            // the dual of the edge is a segment, or a ray if it's an edge of the convex hull
+            bool touches = false;
+            CGAL::Object dual = dt2.dual(*edge);
+            if (const Segment_2* s = CGAL::object_cast<Segment_2>(&dual)) {
+                touches = addCrossings(*s, polygonSegments, index, v, candidates) || isInside(s->source());
+            } else if (const Ray_2* r = CGAL::object_cast<Ray_2>(&dual)) {
+                touches = addCrossings(*r, polygonSegments, index, v, candidates) || isInside(r->source());
+            } else if (const Line_2* l = CGAL::object_cast<Line_2>(&dual)) {
+                touches = addCrossings(*l, polygonSegments, index, v, candidates);
+            }
+            if (touches && found.insert(neighbor->point()).second) pending.push_back(neighbor);
+        } while (++edge != doneEdges);
+    }
+
+    // the same Voronoi vertex may come from several cells, the repeated candidates are removed
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.first < b.first; });
+    candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.first == b.first; }), candidates.end());
+
+    // every candidate is scored walking from the site next to it, which is at most a few steps away
+    std::vector<Point_2> candidatePoints;
+    std::vector<K::FT> candidateScores;
+    candidatePoints.reserve(candidates.size());
+    candidateScores.reserve(candidates.size());
+    for (const Candidate& candidate : candidates) {
+        Delaunay_triangulation_2::Vertex_handle nearest = walkToNearestVertex(dt2, candidate.first, candidate.second);
+        candidatePoints.push_back(candidate.first);
+        candidateScores.push_back(CGAL::squared_distance(candidate.first, nearest->point()));
+    }
+    result.candidates = candidatePoints.size();
+    result.circles = pickLargestEmptyCircles(candidatePoints, candidateScores, std::max<std::size_t>(1, k));
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef POLYGON_LARGEST_EMPTY_CIRCLE_H
+#define POLYGON_LARGEST_EMPTY_CIRCLE_H
+
+#include <cstddef>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// the polygon query finds the largest empty circles (empty of every site of the triangulation) whose center is inside
+// a simple polygon, without building anything new: the distance to the nearest site is largest at a Voronoi vertex
+// inside the polygon, at a crossing of a Voronoi edge with an edge of the polygon or at a vertex of the polygon, and
+// only the Voronoi cells that touch the polygon have them. Those cells are found walking the triangulation from the
+// cell of a vertex of the polygon to the neighbors whose shared Voronoi edge touches the polygon (the cells that touch
+// a connected polygon are connected through such edges), so the cost grows with the cells inside the polygon and not
+// with the number of sites
+
+// result of the polygon query
+struct PolygonLargestEmptyCircle {
+    // the k largest empty circles centered inside the polygon, from the biggest to the smallest
+    std::vector<LargestEmptyCircle> circles;
+    // number of Voronoi cells visited and of candidate points scored
+    std::size_t visitedSites = 0;
+    std::size_t candidates = 0;
+};
+
+// function that returns the k largest empty circles of the sites of the triangulation whose center is inside the
+// polygon, the walk starts from the hint (or from any site if it's null), throws std::runtime_error if the polygon is
+// not simple or the triangulation has less than 3 sites
+PolygonLargestEmptyCircle getPolygonLargestEmptyCircle(const Delaunay_triangulation_2& dt2, const Polygon_2& polygon, std::size_t k = 1, Delaunay_triangulation_2::Vertex_handle hint = Delaunay_triangulation_2::Vertex_handle());
+
+#endif
@@ -0,0 +1,25 @@
+#include "predicateCounters.h"
+
+namespace {
+
+// the counters of every thread
+thread_local PredicateCounts threadPredicateCounts;
+
+}
+
+// function that returns the name of the predicate ("orientation", "side_of_oriented_circle", "compare_distance" or
+// "segment_intersection")
+const char* getCountedPredicateName(CountedPredicate predicate) {
+    switch (predicate) {
+    case CountedPredicate::Orientation: return "orientation";
+    case CountedPredicate::SideOfOrientedCircle: return "side_of_oriented_circle";
+    case CountedPredicate::CompareDistance: return "compare_distance";
+    case CountedPredicate::SegmentIntersection: return "segment_intersection";
+    }
+    return "";
+}
+
+// the counters of the calling thread
+PredicateCounts& getThreadPredicateCounts() {
+    return threadPredicateCounts;
+}
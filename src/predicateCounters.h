@@ -0,0 +1,94 @@
+#ifndef PREDICATE_COUNTERS_H
+#define PREDICATE_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// counters of the geometric predicates, compiled in only with LEC_COUNT_PREDICATES (cmake -DLEC_COUNT_PREDICATES=ON):
+// the triangulation, the convex hull and the polygon then use CountingTraits (countingTraits.h), which count every
+// call of the predicates and every call whose floating point filter fails, so EPICK has to compute it again with exact
+// arithmetic. The counters belong to the thread that calls the predicates (parallelFor adds the counters of its
+// helpers to the calling thread), so the counts of a stage are the difference of the counters of its thread
+
+#ifdef LEC_COUNT_PREDICATES
+// the code inside is only compiled with the predicate counters
+#define LEC_COUNT_PREDICATES_ONLY(...) __VA_ARGS__
+// writes the predicates called by the thread in the rest of the scope into the PredicateCounts pointed to by counts
+#define LEC_COUNT_PREDICATES_SCOPE(counts) ScopedPredicateCounts LEC_COUNT_PREDICATES_NAME(predicateCounts, __LINE__)(counts)
+#define LEC_COUNT_PREDICATES_NAME(name, line) LEC_COUNT_PREDICATES_JOIN(name, line)
+#define LEC_COUNT_PREDICATES_JOIN(name, line) name##line
+const bool kPredicateCountersEnabled = true;
+#else
+#define LEC_COUNT_PREDICATES_ONLY(...)
+#define LEC_COUNT_PREDICATES_SCOPE(counts)
+const bool kPredicateCountersEnabled = false;
+#endif
+
+// the counted predicates
+enum class CountedPredicate {
+    // orientation of three points (also left turns)
+    Orientation,
+    // side of the circle through three points of a fourth one (the in-circle test of the delaunay triangulation)
+    SideOfOrientedCircle,
+    // which of two points is closer to a third one (the walks to the nearest site)
+    CompareDistance,
+    // if two segments intersect (the Voronoi segments against the edges of the convex hull)
+    SegmentIntersection
+};
+
+const std::size_t kCountedPredicates = 4;
+
+// calls and filter failures of every predicate
+struct PredicateCounts {
+    std::uint64_t calls[kCountedPredicates] = {};
+    std::uint64_t filterFailures[kCountedPredicates] = {};
+
+    PredicateCounts& operator+=(const PredicateCounts& other) {
+        for (std::size_t i = 0; i < kCountedPredicates; i++) {
+            calls[i] += other.calls[i];
+            filterFailures[i] += other.filterFailures[i];
+        }
+        return *this;
+    }
+
+    PredicateCounts operator-(const PredicateCounts& other) const {
+        PredicateCounts difference;
+        for (std::size_t i = 0; i < kCountedPredicates; i++) {
+            difference.calls[i] = calls[i] - other.calls[i];
+            difference.filterFailures[i] = filterFailures[i] - other.filterFailures[i];
+        }
+        return difference;
+    }
+};
+
+// function that returns the name of the predicate ("orientation", "side_of_oriented_circle", "compare_distance" or
+// "segment_intersection")
+const char* getCountedPredicateName(CountedPredicate predicate);
+
+// the counters of the calling thread
+PredicateCounts& getThreadPredicateCounts();
+
+// function that counts a call of the predicate on the calling thread
+inline void countPredicate(CountedPredicate predicate, bool filterFailed) {
+    PredicateCounts& counts = getThreadPredicateCounts();
+    counts.calls[static_cast<std::size_t>(predicate)]++;
+    if (filterFailed) counts.filterFailures[static_cast<std::size_t>(predicate)]++;
+}
+
+// writes the predicates called by the thread from its construction to its destruction (nothing if the pointer is
+// null)
+class ScopedPredicateCounts {
+public:
+    explicit ScopedPredicateCounts(PredicateCounts* counts) : m_counts(counts), m_start(getThreadPredicateCounts()) {}
+    ~ScopedPredicateCounts() {
+        if (m_counts) *m_counts = getThreadPredicateCounts() - m_start;
+    }
+    ScopedPredicateCounts(const ScopedPredicateCounts&) = delete;
+    ScopedPredicateCounts& operator=(const ScopedPredicateCounts&) = delete;
+
+private:
+    PredicateCounts* m_counts;
+    PredicateCounts m_start;
+};
+
+#endif
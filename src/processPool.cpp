@@ -0,0 +1,184 @@
+#include "processPool.h"
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// function that writes the whole buffer to the socket, returns false if the other end is gone
+bool writeAll(int socket, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(socket, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+// function that reads exactly size bytes from the socket, returns false if the other end is gone
+bool readAll(int socket, void* data, std::size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t read = ::read(socket, bytes, size);
+        if (read < 0 && errno == EINTR) continue;
+        if (read <= 0) return false;
+        bytes += read;
+        size -= static_cast<std::size_t>(read);
+    }
+    return true;
+}
+
+// function that sends a message (its length and then its bytes) with a flag in front
+bool sendMessage(int socket, std::uint8_t flag, const std::string& message) {
+    std::uint64_t length = message.size();
+    return writeAll(socket, &flag, sizeof(flag)) && writeAll(socket, &length, sizeof(length)) && writeAll(socket, message.data(), message.size());
+}
+
+// function that receives a message sent by sendMessage
+bool receiveMessage(int socket, std::uint8_t& flag, std::string& message) {
+    std::uint64_t length = 0;
+    if (!readAll(socket, &flag, sizeof(flag)) || !readAll(socket, &length, sizeof(length))) return false;
+    message.resize(length);
+    return readAll(socket, &message[0], length);
+}
+
+}
+
+// constructor that forks the workers (by default one per hardware thread), a job whose worker dies is run
+// again on a new worker until it was tried maxAttempts times
+ProcessPool::ProcessPool(Handler handler, std::size_t processes, std::size_t maxAttempts) : m_handler(std::move(handler)), m_maxAttempts(maxAttempts == 0 ? 1 : maxAttempts) {
+    if (processes == 0) processes = std::thread::hardware_concurrency();
+    if (processes == 0) processes = 1;
+    // writing to a dead worker must fail instead of killing the coordinator
+    signal(SIGPIPE, SIG_IGN);
+    for (std::size_t i = 0; i < processes; i++) m_workers.push_back(spawn());
+}
+
+// stops the workers and waits for them
+ProcessPool::~ProcessPool() {
+    for (Worker& worker : m_workers) stop(worker);
+}
+
+// forks a new worker
+ProcessPool::Worker ProcessPool::spawn() {
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) throw std::runtime_error("could not create the socket of a worker");
+    pid_t pid = fork();
+    if (pid < 0) {
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+        throw std::runtime_error("could not fork a worker");
+    }
+    if (pid == 0) {
+        // the worker only keeps its end of its own socket, so the other workers see the coordinator leave
+        ::close(sockets[0]);
+        for (const Worker& other : m_workers) {
+            if (other.socket >= 0) ::close(other.socket);
+        }
+        // a job at a time until the coordinator closes the socket
+        std::uint8_t flag;
+        std::string job;
+        while (receiveMessage(sockets[1], flag, job)) {
+            std::string result;
+            bool ok = true;
+            try {
+                result = m_handler(job);
+            } catch (const std::exception& exception) {
+                ok = false;
+                result = exception.what();
+            }
+            if (!sendMessage(sockets[1], ok ? 1 : 0, result)) break;
+        }
+        // the worker leaves without running the destructors of the coordinator's objects
+        _exit(0);
+    }
+    ::close(sockets[1]);
+    Worker worker;
+    worker.pid = pid;
+    worker.socket = sockets[0];
+    return worker;
+}
+
+// stops a worker and waits for it
+void ProcessPool::stop(Worker& worker) {
+    if (worker.socket >= 0) ::close(worker.socket);
+    if (worker.pid > 0) {
+        while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {}
+    }
+    worker.socket = -1;
+    worker.pid = -1;
+}
+
+// runs every job on the workers and calls onResult in the coordinator as the results arrive
+void ProcessPool::run(const std::vector<std::string>& jobs, const ResultCallback& onResult) {
+    std::deque<std::size_t> pending;
+    for (std::size_t i = 0; i < jobs.size(); i++) pending.push_back(i);
+    std::vector<std::size_t> attempts(jobs.size(), 0);
+    // the job that every worker is running (jobs.size() if it's idle)
+    std::vector<std::size_t> running(m_workers.size(), jobs.size());
+    std::size_t busy = 0;
+
+    // a worker that died is replaced and its job is tried again (or fails if it was tried too many times)
+    auto replaceWorker = [&](std::size_t i) {
+        std::size_t job = running[i];
+        stop(m_workers[i]);
+        m_crashes++;
+        m_workers[i] = spawn();
+        running[i] = jobs.size();
+        busy--;
+        if (attempts[job] < m_maxAttempts) pending.push_front(job);
+        else onResult(job, false, "the worker died " + std::to_string(attempts[job]) + " times running the job");
+    };
+
+    while (!pending.empty() || busy > 0) {
+        // every idle worker gets the next job
+        for (std::size_t i = 0; i < m_workers.size() && !pending.empty(); i++) {
+            if (running[i] != jobs.size()) continue;
+            std::size_t job = pending.front();
+            pending.pop_front();
+            attempts[job]++;
+            running[i] = job;
+            busy++;
+            if (!sendMessage(m_workers[i].socket, 1, jobs[job])) replaceWorker(i);
+        }
+        if (busy == 0) continue;
+
+        // waits for the results of the busy workers
+        std::vector<pollfd> descriptors;
+        std::vector<std::size_t> polledWorkers;
+        for (std::size_t i = 0; i < m_workers.size(); i++) {
+            if (running[i] == jobs.size()) continue;
+            descriptors.push_back(pollfd{m_workers[i].socket, POLLIN, 0});
+            polledWorkers.push_back(i);
+        }
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("could not wait for the workers");
+        }
+        for (std::size_t j = 0; j < descriptors.size(); j++) {
+            if (descriptors[j].revents == 0) continue;
+            std::size_t i = polledWorkers[j];
+            std::uint8_t ok = 0;
+            std::string result;
+            if (!receiveMessage(m_workers[i].socket, ok, result)) {
+                replaceWorker(i);
+                continue;
+            }
+            std::size_t job = running[i];
+            running[i] = jobs.size();
+            busy--;
+            onResult(job, ok != 0, result);
+        }
+    }
+}
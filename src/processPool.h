@@ -0,0 +1,57 @@
+#ifndef PROCESS_POOL_H
+#define PROCESS_POOL_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// pool of worker processes forked from the coordinator, every worker is connected to the coordinator by a Unix
+// domain socket pair where it receives one job at a time and sends back its result (both as length prefixed
+// messages), the workers inherit everything the coordinator had in memory when they were forked (and the files it
+// mapped), so the jobs only need to say which part of the input to solve
+class ProcessPool {
+public:
+    // function that runs a job in a worker and returns its result, it may throw (the job fails with the message)
+    typedef std::function<std::string(const std::string&)> Handler;
+    // function called in the coordinator with the index of a job, if it succeeded and its result (or error)
+    typedef std::function<void(std::size_t, bool, const std::string&)> ResultCallback;
+
+    // constructor that forks the workers (by default one per hardware thread), a job whose worker dies is run
+    // again on a new worker until it was tried maxAttempts times
+    explicit ProcessPool(Handler handler, std::size_t processes = 0, std::size_t maxAttempts = 3);
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    // stops the workers and waits for them
+    ~ProcessPool();
+
+    // runs every job on the workers and calls onResult in the coordinator as the results arrive
+    void run(const std::vector<std::string>& jobs, const ResultCallback& onResult);
+
+    // the number of workers
+    std::size_t size() const { return m_workers.size(); }
+    // the number of workers that died while running a job
+    std::size_t crashes() const { return m_crashes; }
+
+private:
+    // worker process and the coordinator end of its socket
+    struct Worker {
+        pid_t pid = -1;
+        int socket = -1;
+    };
+
+    // forks a new worker
+    Worker spawn();
+    // stops a worker and waits for it
+    void stop(Worker& worker);
+
+    Handler m_handler;
+    std::size_t m_maxAttempts;
+    std::vector<Worker> m_workers;
+    std::size_t m_crashes = 0;
+};
+
+#endif
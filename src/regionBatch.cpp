@@ -0,0 +1,154 @@
+#include "regionBatch.h"
+#include "geojsonReader.h"
+#include "traceEvents.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// function that returns the route of a geojson file of the region, compressed or not, empty if there isn't one
+std::string findGeojson(const std::filesystem::path& directory, const std::string& name) {
+    for (const char* extension : {".geojson", ".geojson.gz", ".geojson.zst"}) {
+        std::filesystem::path route = directory / (name + extension);
+        std::error_code error;
+        if (std::filesystem::is_regular_file(route, error)) return route.string();
+    }
+    return std::string();
+}
+
+}
+
+// function that returns the regions found in the subdirectories of the data directory, sorted from the biggest
+// input to the smallest one
+std::vector<Region> discoverRegions(const std::string& dataDirectory) {
+    std::vector<Region> regions;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(dataDirectory, error)) {
+        if (!entry.is_directory(error)) continue;
+        // a region needs both the boundary and the sites
+        Region region;
+        region.name = entry.path().filename().string();
+        region.boundaryFilename = findGeojson(entry.path() / "geojson", "boundary");
+        region.sitesFilename = findGeojson(entry.path() / "geojson", "schools");
+        if (region.boundaryFilename.empty() || region.sitesFilename.empty()) continue;
+        region.inputBytes = std::filesystem::file_size(region.boundaryFilename, error) + std::filesystem::file_size(region.sitesFilename, error);
+        regions.push_back(region);
+    }
+    // the biggest regions first, and by name to keep the order stable
+    std::sort(regions.begin(), regions.end(), [](const Region& a, const Region& b) {
+        if (a.inputBytes != b.inputBytes) return a.inputBytes > b.inputBytes;
+        return a.name < b.name;
+    });
+    return regions;
+}
+
+// function that reads a region and computes its largest empty circle, the errors are stored in the result
+RegionResult solveRegion(const Region& region) {
+    RegionResult result;
+    result.name = region.name;
+    // the spans of the stages are tagged with the region and nested in its span
+    TraceRegion traceRegion(region.name);
+    TraceSpan span(region.name, "region");
+    auto start = std::chrono::steady_clock::now();
+    try {
+        std::vector<Point_2> points;
+        {
+            TraceSpan ingestSpan("ingest");
+            points = readInputPoints(region.boundaryFilename, region.sitesFilename);
+        }
+        result.numberOfPoints = points.size();
+        if (points.size() < 3) throw std::runtime_error("at least 3 points are needed");
+        result.circle = getLargestEmptyCircle(points);
+        result.ok = true;
+    } catch (const std::exception& exception) {
+        result.error = exception.what();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// function that solves the regions in a pipeline ingest -> triangulate -> candidates -> score with bounded queues
+// between the stages, so a region is read while the previous one is triangulated, and calls onResult (from one
+// thread) as the regions finish, returns the statistics of the stages
+std::vector<StagePipeline<RegionWork>::StageStatistics> solveRegionsPipelined(const std::vector<Region>& regions, std::size_t threads, const std::function<void(const RegionResult&)>& onResult) {
+    if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    // at most threads regions wait between two stages, so the memory stays bounded
+    StagePipeline<RegionWork> pipeline(threads);
+
+    // the reading is I/O bound, two readers keep the decompression and the parsing busy
+    // every stage tags its spans with the region it's working on
+    pipeline.addStage("ingest", 2, [](RegionWork& work) {
+        TraceRegion traceRegion(work.region.name);
+        TraceSpan span("ingest");
+        work.start = std::chrono::steady_clock::now();
+        try {
+            work.points = readInputPoints(work.region.boundaryFilename, work.region.sitesFilename);
+            work.result.numberOfPoints = work.points.size();
+            if (work.points.size() < 3) throw std::runtime_error("at least 3 points are needed");
+        } catch (const std::exception& exception) {
+            work.result.error = exception.what();
+        }
+    });
+    // the CPU bound stages share the threads, the triangulation is the most expensive one (a stage must not throw, so
+    // the error of a region is kept in its result and the next stages skip it)
+    pipeline.addStage("triangulate", std::max<std::size_t>(1, threads / 2), [](RegionWork& work) {
+        if (!work.result.error.empty()) return;
+        TraceRegion traceRegion(work.region.name);
+        try {
+            runTriangulationStage(work.points, work.stages);
+        } catch (const std::exception& exception) {
+            work.result.error = exception.what();
+        }
+        std::vector<Point_2>().swap(work.points);
+    });
+    pipeline.addStage("candidates", std::max<std::size_t>(1, threads / 4), [](RegionWork& work) {
+        if (!work.result.error.empty()) return;
+        TraceRegion traceRegion(work.region.name);
+        try {
+            runCandidateStage(work.stages);
+        } catch (const std::exception& exception) {
+            work.result.error = exception.what();
+        }
+    });
+    pipeline.addStage("score", std::max<std::size_t>(1, threads / 4), [](RegionWork& work) {
+        if (!work.result.error.empty()) return;
+        TraceRegion traceRegion(work.region.name);
+        try {
+            runScoreStage(work.stages);
+            work.result.circle = work.stages.circle;
+            work.result.ok = true;
+        } catch (const std::exception& exception) {
+            work.result.error = exception.what();
+        }
+    });
+
+    pipeline.run(regions.size(), [&regions](std::size_t i) {
+        std::unique_ptr<RegionWork> work(new RegionWork());
+        work->region = regions[i];
+        work->result.name = regions[i].name;
+        return work;
+    }, [&onResult](std::unique_ptr<RegionWork> work) {
+        work->result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - work->start).count();
+        onResult(work->result);
+    });
+    return pipeline.statistics();
+}
+
+// function that returns the result as one line of JSON (without the line break)
+std::string formatRegionResult(const RegionResult& result) {
+    nlohmann::json record;
+    record["region"] = result.name;
+    if (result.ok) {
+        record["points"] = result.numberOfPoints;
+        record["center"] = {CGAL::to_double(result.circle.center.x()), CGAL::to_double(result.circle.center.y())};
+        record["radius"] = result.circle.radius();
+    } else {
+        record["error"] = result.error;
+    }
+    record["seconds"] = result.seconds;
+    return record.dump();
+}
@@ -0,0 +1,59 @@
+#ifndef REGION_BATCH_H
+#define REGION_BATCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+#include "stagePipeline.h"
+
+// region (comuna) of a data directory: data/<name>/geojson/boundary.geojson and data/<name>/geojson/schools.geojson
+// (the geojson files may also be compressed: .geojson.gz or .geojson.zst)
+struct Region {
+    std::string name;
+    std::string boundaryFilename;
+    std::string sitesFilename;
+    // size of both input files, used to schedule the biggest regions first
+    std::uintmax_t inputBytes = 0;
+};
+
+// result of the largest empty circle of a region
+struct RegionResult {
+    std::string name;
+    // false if the region could not be solved, error says why
+    bool ok = false;
+    std::string error;
+    std::size_t numberOfPoints = 0;
+    LargestEmptyCircle circle;
+    // time spent reading and solving the region
+    double seconds = 0;
+};
+
+// region going through the stages of the batch pipeline
+struct RegionWork {
+    Region region;
+    RegionResult result;
+    // the points read by the ingest stage (released after the triangulation)
+    std::vector<Point_2> points;
+    LargestEmptyCircleStages stages;
+    std::chrono::steady_clock::time_point start;
+};
+
+// function that returns the regions found in the subdirectories of the data directory, sorted from the biggest
+// input to the smallest one
+std::vector<Region> discoverRegions(const std::string& dataDirectory);
+
+// function that reads a region and computes its largest empty circle, the errors are stored in the result
+RegionResult solveRegion(const Region& region);
+
+// function that solves the regions in a pipeline ingest -> triangulate -> candidates -> score with bounded queues
+// between the stages, so a region is read while the previous one is triangulated, and calls onResult (from one
+// thread) as the regions finish, returns the statistics of the stages
+std::vector<StagePipeline<RegionWork>::StageStatistics> solveRegionsPipelined(const std::vector<Region>& regions, std::size_t threads, const std::function<void(const RegionResult&)>& onResult);
+
+// function that returns the result as one line of JSON (without the line break)
+std::string formatRegionResult(const RegionResult& result);
+
+#endif
@@ -0,0 +1,72 @@
+#include "resultCache.h"
+
+// constructor with the number of slots and the most bytes taken by the cached values and parameters
+ResultCache::ResultCache(std::size_t slots, std::size_t maxBytes)
+    : m_slots(slots == 0 ? 1 : slots), m_maxBytes(maxBytes), m_table(new std::atomic<const Entry*>[m_slots]) {
+    for (std::size_t i = 0; i < m_slots; i++) m_table[i].store(nullptr, std::memory_order_relaxed);
+}
+
+// the entries still in the table are destroyed, the retired ones are destroyed by the reclamation
+ResultCache::~ResultCache() {
+    for (std::size_t i = 0; i < m_slots; i++) delete m_table[i].load(std::memory_order_relaxed);
+}
+
+// copies the value of the query (the content hash of its dataset and its parameters) to value, returns false if it
+// isn't cached
+bool ResultCache::find(std::uint64_t datasetHash, const std::string& parameters, std::string& value) const {
+    // the entry can't be destroyed while the epoch is pinned, even if a writer replaces it
+    EpochReclamation::Guard guard = m_reclamation.pin();
+    const Entry* entry = m_table[getCacheKey(datasetHash, parameters) % m_slots].load(std::memory_order_acquire);
+    if (entry && entry->datasetHash == datasetHash && entry->parameters == parameters) {
+        value = entry->value;
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// caches the value of the query (unless it alone takes more than the byte budget), the entries of other slots are
+// evicted if the cached values take more than the budget
+void ResultCache::store(std::uint64_t datasetHash, const std::string& parameters, const std::string& value) {
+    if (value.empty()) return;
+    // the entries nobody reads anymore are destroyed first
+    m_reclamation.collect();
+    std::unique_ptr<Entry> entry(new Entry{datasetHash, parameters, value});
+    std::size_t bytes = entry->bytes();
+    if (bytes > m_maxBytes) return;
+
+    // the new entry always takes its slot, so the entries of the datasets that changed are replaced over time
+    const Entry* stored = entry.release();
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    removeEntry(m_table[getCacheKey(datasetHash, parameters) % m_slots].exchange(stored, std::memory_order_acq_rel));
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+
+    // over the budget the other slots are emptied going round the table, at most once around it
+    for (std::size_t i = 0; i < m_slots && m_bytes.load(std::memory_order_relaxed) > m_maxBytes; i++) {
+        std::atomic<const Entry*>& slot = m_table[m_evictionHand.fetch_add(1, std::memory_order_relaxed) % m_slots];
+        const Entry* evicted = slot.load(std::memory_order_relaxed);
+        if (evicted == nullptr || evicted == stored) continue;
+        if (slot.compare_exchange_strong(evicted, nullptr, std::memory_order_acq_rel)) removeEntry(evicted);
+    }
+}
+
+// takes out the bytes of an entry that left the table and retires it (nothing if it's null)
+void ResultCache::removeEntry(const Entry* entry) {
+    if (entry == nullptr) return;
+    m_bytes.fetch_sub(entry->bytes(), std::memory_order_relaxed);
+    // the readers that loaded the entry may still be copying it
+    m_reclamation.retire([entry]() { delete entry; });
+}
+
+// function that returns the hash of a query: the content hash of the dataset mixed with the hash of the parameters of
+// the query (with the region of the query, if any)
+std::uint64_t getCacheKey(std::uint64_t datasetHash, const std::string& parameters) {
+    // FNV-1a over the parameters, starting from the hash of the dataset
+    std::uint64_t hash = 14695981039346656037ull ^ datasetHash;
+    for (unsigned char c : parameters) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,75 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "epochReclamation.h"
+
+// cache of query results shared by the threads of the server: a table of slots where a query always goes to the same
+// slot (by the hash of its dataset and its parameters), so a lookup is a hash, a comparison and a copy. Every slot
+// points to an immutable entry with the content hash of the dataset, the canonical parameters of the query and the
+// value, kept out of the table so a value of any size can be cached. A writer builds a new entry and swaps it into the
+// slot, and the entry it replaced is retired with epoch based reclamation, so the readers never take a lock or write
+// anything shared (besides the counters and their own reclamation slot). A lookup compares the dataset hash and the
+// parameters of the entry, so two queries whose hashes collide never get each other's result. A new query takes the
+// slot of the old one, and when the cached values take more than the byte budget the entries of other slots are
+// evicted going round the table (a value bigger than the whole budget is not cached)
+class ResultCache {
+public:
+    // constructor with the number of slots and the most bytes taken by the cached values and parameters
+    explicit ResultCache(std::size_t slots, std::size_t maxBytes = std::size_t(64) << 20);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    ~ResultCache();
+
+    // copies the value of the query (the content hash of its dataset and its parameters) to value, returns false if it
+    // isn't cached
+    bool find(std::uint64_t datasetHash, const std::string& parameters, std::string& value) const;
+
+    // caches the value of the query (unless it alone takes more than the byte budget), the entries of other slots are
+    // evicted if the cached values take more than the budget
+    void store(std::uint64_t datasetHash, const std::string& parameters, const std::string& value);
+
+    std::size_t slots() const { return m_slots; }
+    std::size_t bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+    std::uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+    std::uint64_t stores() const { return m_stores.load(std::memory_order_relaxed); }
+
+private:
+    // an immutable cached result
+    struct Entry {
+        std::uint64_t datasetHash;
+        std::string parameters;
+        std::string value;
+
+        std::size_t bytes() const { return sizeof(Entry) + parameters.size() + value.size(); }
+    };
+
+    // takes out the bytes of an entry that left the table and retires it (nothing if it's null)
+    void removeEntry(const Entry* entry);
+
+    std::size_t m_slots;
+    std::size_t m_maxBytes;
+    // the entry of every slot, null if the slot is empty
+    std::unique_ptr<std::atomic<const Entry*>[]> m_table;
+    // bytes taken by the entries in the table
+    std::atomic<std::size_t> m_bytes{0};
+    // the next slot emptied when the cache is over the budget
+    std::atomic<std::size_t> m_evictionHand{0};
+    mutable EpochReclamation m_reclamation;
+    mutable std::atomic<std::uint64_t> m_hits{0};
+    mutable std::atomic<std::uint64_t> m_misses{0};
+    std::atomic<std::uint64_t> m_stores{0};
+};
+
+// function that returns the hash of a query: the content hash of the dataset mixed with the hash of the parameters of
+// the query (with the region of the query, if any)
+std::uint64_t getCacheKey(std::uint64_t datasetHash, const std::string& parameters);
+
+#endif
@@ -0,0 +1,132 @@
+#include "shardedLargestEmptyCircle.h"
+#include "mappedFile.h"
+#include "processPool.h"
+#include "tiledLargestEmptyCircle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// function that writes the sites sorted by tile: the offset of the first site of every tile (and the total) as
+// 64 bit integers and then the x, y coordinates of the sites as doubles
+void writeSitesFile(const std::string& filename, const std::vector<Point_2>& points, const TileGrid& tileGrid) {
+    std::vector<std::uint64_t> tileStart(tileGrid.size() + 1, 0);
+    std::vector<std::size_t> tiles(points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        tiles[i] = tileGrid.getTileIndex(points[i]);
+        tileStart[tiles[i] + 1]++;
+    }
+    for (std::size_t i = 1; i < tileStart.size(); i++) tileStart[i] += tileStart[i - 1];
+    std::vector<std::uint64_t> next(tileStart.begin(), tileStart.end() - 1);
+    std::vector<double> coordinates(2 * points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        std::uint64_t position = next[tiles[i]]++;
+        coordinates[2 * position] = CGAL::to_double(points[i].x());
+        coordinates[2 * position + 1] = CGAL::to_double(points[i].y());
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(tileStart.data()), tileStart.size() * sizeof(std::uint64_t));
+    file.write(reinterpret_cast<const char*>(coordinates.data()), coordinates.size() * sizeof(double));
+    file.close();
+    if (!file) throw std::runtime_error("could not write the sites file " + filename);
+}
+
+// function that returns the sites of the mapped sites file inside the rectangle
+std::vector<Point_2> getMappedSitesInside(const MappedFile& sitesFile, const TileGrid& tileGrid, const Iso_rectangle_2& rectangle) {
+    const std::uint64_t* tileStart = reinterpret_cast<const std::uint64_t*>(sitesFile.data());
+    const double* coordinates = reinterpret_cast<const double*>(tileStart + tileGrid.size() + 1);
+    std::vector<Point_2> sites;
+    double xmin = CGAL::to_double(rectangle.xmin()), ymin = CGAL::to_double(rectangle.ymin());
+    double xmax = CGAL::to_double(rectangle.xmax()), ymax = CGAL::to_double(rectangle.ymax());
+    // only the tiles that overlap the rectangle are visited
+    for (std::size_t row = tileGrid.getRow(ymin); row <= tileGrid.getRow(ymax); row++) {
+        for (std::size_t column = tileGrid.getColumn(xmin); column <= tileGrid.getColumn(xmax); column++) {
+            std::size_t tile = row * tileGrid.tilesPerSide + column;
+            for (std::uint64_t i = tileStart[tile]; i < tileStart[tile + 1]; i++) {
+                double x = coordinates[2 * i], y = coordinates[2 * i + 1];
+                if (x >= xmin && x <= xmax && y >= ymin && y <= ymax) sites.push_back(Point_2(x, y));
+            }
+        }
+    }
+    return sites;
+}
+
+}
+
+// function that returns the largest empty circles of the points solving the tiles in worker processes, throws
+// std::runtime_error if the sites file can't be written or the workers can't be started
+ShardedLargestEmptyCircle getShardedLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const ShardedOptions& options) {
+    ShardedLargestEmptyCircle sharded;
+    if (inputPointsCGAL.empty()) return sharded;
+    std::size_t k = std::max<std::size_t>(1, options.topK);
+
+    std::size_t processes = options.processes;
+    if (processes == 0) processes = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::size_t tilesPerSide = options.tilesPerSide;
+    if (tilesPerSide == 0) tilesPerSide = static_cast<std::size_t>(std::ceil(std::sqrt(8.0 * processes)));
+    TileGrid tileGrid = makeTileGrid(inputPointsCGAL, tilesPerSide);
+    sharded.tiles = tileGrid.size();
+
+    // the convex hull is computed once by the coordinator and inherited by the workers
+    Polygon_2 ch = getConvexHull(inputPointsCGAL);
+    std::vector<Segment_2> chSegments = getPolygonSegments(ch);
+    double width = std::max(tileGrid.maxX - tileGrid.minX, tileGrid.tileWidth);
+    double height = std::max(tileGrid.maxY - tileGrid.minY, tileGrid.tileHeight);
+    double firstHalo = options.haloFactor * std::sqrt(width * height / inputPointsCGAL.size());
+
+    // the sites file is mapped before the fork, so the workers share its pages
+    std::string sitesFilename = (std::filesystem::path(options.workDirectory) / ("lec-sites-" + std::to_string(getpid()) + ".bin")).string();
+    writeSitesFile(sitesFilename, inputPointsCGAL, tileGrid);
+    MappedFile sitesFile(sitesFilename);
+    std::remove(sitesFilename.c_str());
+    if (!sitesFile.isOpen()) throw std::runtime_error("could not map the sites file " + sitesFilename);
+
+    // a job is the number of a tile, its result is the number of grown halos and the center and squared radius of
+    // its circles
+    ProcessPool pool([&](const std::string& job) {
+        std::size_t tile = std::stoul(job);
+        std::size_t haloExpansions = 0;
+        auto getSites = [&sitesFile, &tileGrid](const Iso_rectangle_2& rectangle) { return getMappedSitesInside(sitesFile, tileGrid, rectangle); };
+        TileResult result = solveLargestEmptyCircleTileWithHalo(tileGrid, tile, getSites, ch, chSegments, firstHalo, haloExpansions, k);
+        std::ostringstream output;
+        output.precision(17);
+        output << haloExpansions << ' ' << result.circles.size();
+        for (const LargestEmptyCircle& circle : result.circles) {
+            output << ' ' << CGAL::to_double(circle.center.x()) << ' ' << CGAL::to_double(circle.center.y()) << ' ' << CGAL::to_double(circle.squaredRadius);
+        }
+        return output.str();
+    }, processes, options.maxAttempts);
+    sharded.processes = pool.size();
+
+    std::vector<std::string> jobs;
+    for (std::size_t tile = 0; tile < tileGrid.size(); tile++) jobs.push_back(std::to_string(tile));
+    pool.run(jobs, [&](std::size_t, bool ok, const std::string& output) {
+        if (!ok) {
+            sharded.failedTiles++;
+            return;
+        }
+        std::istringstream input(output);
+        std::size_t haloExpansions = 0, numberOfCircles = 0;
+        input >> haloExpansions >> numberOfCircles;
+        sharded.haloExpansions += haloExpansions;
+        std::vector<LargestEmptyCircle> circles(numberOfCircles);
+        for (LargestEmptyCircle& circle : circles) {
+            double x = 0, y = 0, squaredRadius = 0;
+            input >> x >> y >> squaredRadius;
+            circle.center = Point_2(x, y);
+            circle.squaredRadius = squaredRadius;
+        }
+        mergeLargestEmptyCircles(sharded.circles, circles, k);
+    });
+    sharded.crashes = pool.crashes();
+    return sharded;
+}
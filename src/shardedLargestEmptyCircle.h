@@ -0,0 +1,45 @@
+#ifndef SHARDED_LARGEST_EMPTY_CIRCLE_H
+#define SHARDED_LARGEST_EMPTY_CIRCLE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// the sharded mode solves the tiles of the tiled mode in worker processes instead of threads: the coordinator
+// writes the sites sorted by tile to a file and maps it before forking the workers, so every worker reads the same
+// pages of the file without copying them, and only the tile numbers and the circles go through the sockets
+
+// options of the sharded largest empty circle
+struct ShardedOptions {
+    // number of worker processes (0 is one per hardware thread)
+    std::size_t processes = 0;
+    // number of tiles on each side of the grid (0 picks enough tiles for 8 per process)
+    std::size_t tilesPerSide = 0;
+    // first halo around every tile, in mean distances between sites
+    double haloFactor = 4;
+    // number of circles kept
+    std::size_t topK = 1;
+    // number of times a tile is tried when its worker dies
+    std::size_t maxAttempts = 3;
+    // directory for the file with the sites sorted by tile (it's removed at the end)
+    std::string workDirectory = "/tmp";
+};
+
+// result of the sharded largest empty circle
+struct ShardedLargestEmptyCircle {
+    // the k largest empty circles, from the biggest to the smallest
+    std::vector<LargestEmptyCircle> circles;
+    std::size_t tiles = 0;
+    std::size_t processes = 0;
+    std::size_t haloExpansions = 0;
+    // number of workers that died and of tiles that failed every attempt (if any failed the circles are not exact)
+    std::size_t crashes = 0;
+    std::size_t failedTiles = 0;
+};
+
+// function that returns the largest empty circles of the points solving the tiles in worker processes, throws
+// std::runtime_error if the sites file can't be written or the workers can't be started
+ShardedLargestEmptyCircle getShardedLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const ShardedOptions& options = ShardedOptions());
+
+#endif
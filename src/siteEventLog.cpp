@@ -0,0 +1,271 @@
+#include "siteEventLog.h"
+#include "geojsonReader.h"
+#include "triangulationSnapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// first line of a checkpoint, with the version of its format
+const char* kCheckpointHeader = "lec-site-checkpoint 1";
+
+// function that returns the token that ties the sites of a checkpoint to its snapshot, from the offset of the log and
+// the content of the dataset
+std::uint64_t getCheckpointToken(std::uint64_t offset, std::uint64_t contentHash) {
+    std::uint64_t token = contentHash ^ (offset * 0x9e3779b97f4a7c15ull);
+    token = (token ^ (token >> 31)) * 0xbf58476d1ce4e5b9ull;
+    return token ^ (token >> 29);
+}
+
+// function that returns the name of the snapshot of a checkpoint, every checkpoint has its own so the previous one is
+// still whole until the new one replaces it
+std::string getCheckpointSnapshotFilename(const std::string& checkpointFilename, std::uint64_t token) {
+    std::ostringstream filename;
+    filename << checkpointFilename << '.' << std::hex << std::setw(16) << std::setfill('0') << token << ".snapshot";
+    return filename.str();
+}
+
+// function that parses one line of the log, throws std::runtime_error if it's malformed
+SiteEvent parseSiteEvent(const std::string& line, const std::string& filename, std::uint64_t offset) {
+    std::istringstream fields(line);
+    std::string type;
+    SiteEvent event;
+    double x = 0, y = 0;
+    fields >> type >> event.id;
+    if (type == "open" || type == "move") {
+        event.type = type == "open" ? SiteEvent::Open : SiteEvent::Move;
+        fields >> x >> y;
+        event.point = Point_2(x, y);
+    } else if (type == "close") {
+        event.type = SiteEvent::Close;
+    } else {
+        fields.setstate(std::ios::failbit);
+    }
+    std::string extra;
+    if (fields.fail() || event.id.empty() || (fields >> extra)) {
+        throw std::runtime_error("malformed event at byte " + std::to_string(offset) + " of " + filename + ": " + line);
+    }
+    return event;
+}
+
+}
+
+// function that reads the complete lines of the log from offset (in bytes) to its end, at most maxEvents of them, and
+// moves offset after the last one that was read, throws std::runtime_error if a line is malformed or the log is
+// shorter than offset (it was truncated or replaced). If malformed isn't null a malformed line is skipped instead,
+// and the error is added to it
+std::vector<SiteEvent> readSiteEvents(const std::string& filename, std::uint64_t& offset, std::size_t maxEvents, std::vector<std::string>* malformed) {
+    std::vector<SiteEvent> events;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        // a log that wasn't created yet has no events
+        if (offset == 0) return events;
+        throw std::runtime_error("could not open " + filename);
+    }
+    file.seekg(0, std::ios::end);
+    if (static_cast<std::uint64_t>(file.tellg()) < offset) throw std::runtime_error(filename + " is shorter than the events already applied");
+    file.seekg(static_cast<std::streamoff>(offset));
+
+    // the tail is read in blocks, pending holds the part of a line that continues in the next block
+    std::string pending;
+    std::vector<char> block(1 << 16);
+    std::uint64_t position = offset;
+    while (events.size() < maxEvents) {
+        file.read(block.data(), block.size());
+        std::size_t length = static_cast<std::size_t>(file.gcount());
+        if (length == 0) break;
+        pending.append(block.data(), length);
+        std::size_t lineStart = 0, lineEnd;
+        while (events.size() < maxEvents && (lineEnd = pending.find('\n', lineStart)) != std::string::npos) {
+            std::string line = pending.substr(lineStart, lineEnd - lineStart);
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                try {
+                    events.push_back(parseSiteEvent(line, filename, position + lineStart));
+                } catch (const std::runtime_error& error) {
+                    if (!malformed) throw;
+                    malformed->push_back(error.what());
+                }
+            }
+            lineStart = lineEnd + 1;
+        }
+        pending.erase(0, lineStart);
+        position += lineStart;
+    }
+    offset = position;
+    return events;
+}
+
+// function that appends the event to the log as one line, returns false if it can't be written
+bool appendSiteEvent(const std::string& filename, const SiteEvent& event) {
+    std::ofstream file(filename, std::ios::app);
+    if (!file) return false;
+    file << std::setprecision(17);
+    if (event.type == SiteEvent::Close) file << "close " << event.id << '\n';
+    else file << (event.type == SiteEvent::Open ? "open " : "move ") << event.id << ' ' << CGAL::to_double(event.point.x()) << ' ' << CGAL::to_double(event.point.y()) << '\n';
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+// function that applies the events to the layer in order (closing an id that isn't open is ignored)
+void applySiteEvents(SiteLayer& layer, const std::vector<SiteEvent>& events) {
+    for (const SiteEvent& event : events) {
+        if (event.type == SiteEvent::Close) layer.sites.erase(event.id);
+        else layer.sites[event.id] = event.point;
+    }
+}
+
+// constructor that restores the dataset from the checkpoint and replays the log after it, or, if there's no valid
+// checkpoint, builds the dataset from the boundary and the sites files and replays the whole log (and writes a
+// checkpoint), throws std::runtime_error if the files can't be read
+SiteEventConsumer::SiteEventConsumer(const std::string& name, const std::string& boundaryFilename, const std::string& sitesFilename, const std::string& logFilename, const std::string& checkpointFilename, const Options& options)
+    : m_name(name), m_logFilename(logFilename), m_checkpointFilename(checkpointFilename), m_options(options) {
+    auto start = std::chrono::steady_clock::now();
+    m_restored = restore();
+    if (!m_restored) {
+        readBoundaryPoints(boundaryFilename, m_boundary);
+        m_layer = readSiteLayer(sitesFilename);
+        std::vector<Point_2> points = m_boundary;
+        for (const auto& site : m_layer.sites) points.push_back(site.second);
+        m_dataset = makeDataset(m_name, points, m_options.threads);
+        m_offset = 0;
+    }
+    m_replayedEvents = poll();
+    // the first checkpoint saves the replay of the whole log to the next start
+    if (!m_restored) checkpoint();
+    m_recoverySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// applies the events appended to the log since the last call, returns how many were applied
+std::size_t SiteEventConsumer::poll() {
+    std::size_t applied = 0;
+    while (true) {
+        // the offset only moves once the batch is applied, so a batch that fails for lack of memory is read again by the
+        // next call, but a malformed line or an event the dataset can't take would fail every time, so they are skipped
+        // (and counted) instead
+        std::uint64_t offset = m_offset;
+        std::vector<std::string> malformed;
+        std::vector<SiteEvent> events = readSiteEvents(m_logFilename, offset, m_options.batchSize, &malformed);
+        std::size_t skipped = m_skippedEvents;
+        if (!events.empty()) applyOrSkip(events);
+        m_offset = offset;
+        if (!malformed.empty()) {
+            m_skippedLines += malformed.size();
+            m_lastSkippedLine = malformed.back();
+        }
+        if (events.empty()) break;
+        applied += events.size() - (m_skippedEvents - skipped);
+        m_eventsSinceCheckpoint += events.size();
+        if (m_options.checkpointEvents > 0 && m_eventsSinceCheckpoint >= m_options.checkpointEvents) checkpoint();
+    }
+    return applied;
+}
+
+// applies one batch of events, if the batch fails its events are applied one by one and the ones that fail are skipped
+void SiteEventConsumer::applyOrSkip(const std::vector<SiteEvent>& events) {
+    try {
+        apply(events);
+        return;
+    } catch (const std::bad_alloc&) {
+        throw;
+    } catch (const std::exception&) {
+    }
+    for (const SiteEvent& event : events) {
+        try {
+            apply(std::vector<SiteEvent>(1, event));
+        } catch (const std::bad_alloc&) {
+            throw;
+        } catch (const std::exception& error) {
+            m_skippedEvents++;
+            m_lastSkippedEvent = event.id + ": " + error.what();
+        }
+    }
+}
+
+// applies one batch of events
+void SiteEventConsumer::apply(const std::vector<SiteEvent>& events) {
+    // the batch is applied to a copy of the layer, and the difference with the current one is one update
+    SiteLayer layer = m_layer;
+    applySiteEvents(layer, events);
+    SiteLayerDiff diff = diffSiteLayers(m_layer, layer, m_boundary);
+    if (!diff.empty()) {
+        std::shared_ptr<const Dataset> updated = updateDataset(*m_dataset, diff.inserted, diff.removed, m_options.threads);
+        if (updated) m_dataset = updated;
+    }
+    m_layer = std::move(layer);
+}
+
+// writes the checkpoint of the events applied so far, returns false if it can't be written
+bool SiteEventConsumer::checkpoint() {
+    std::uint64_t token = getCheckpointToken(m_offset, m_dataset->contentHash);
+    std::string snapshotFilename = getCheckpointSnapshotFilename(m_checkpointFilename, token);
+    // the snapshot is written first, the checkpoint only points to it once it's whole
+    if (!writeSnapshot(snapshotFilename, token, m_dataset->stages)) return false;
+
+    // the previous snapshot is removed once the new checkpoint replaces it
+    std::string previousSnapshot;
+    {
+        std::ifstream previous(m_checkpointFilename);
+        std::string header, key, previousOffset;
+        std::uint64_t previousToken;
+        if (std::getline(previous, header) && header == kCheckpointHeader && previous >> key >> previousOffset >> key >> std::hex >> previousToken) {
+            previousSnapshot = getCheckpointSnapshotFilename(m_checkpointFilename, previousToken);
+        }
+    }
+
+    std::string temporaryFilename = m_checkpointFilename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename);
+        file << std::setprecision(17) << kCheckpointHeader << '\n';
+        file << "offset " << m_offset << '\n';
+        file << "token " << std::hex << token << std::dec << '\n';
+        file << "boundary " << m_boundary.size() << '\n';
+        for (const Point_2& point : m_boundary) file << CGAL::to_double(point.x()) << ' ' << CGAL::to_double(point.y()) << '\n';
+        file << "sites " << m_layer.sites.size() << '\n';
+        for (const auto& site : m_layer.sites) file << site.first << ' ' << CGAL::to_double(site.second.x()) << ' ' << CGAL::to_double(site.second.y()) << '\n';
+        file.flush();
+        if (!file) return false;
+    }
+    if (std::rename(temporaryFilename.c_str(), m_checkpointFilename.c_str()) != 0) return false;
+    if (!previousSnapshot.empty() && previousSnapshot != snapshotFilename) std::remove(previousSnapshot.c_str());
+    m_eventsSinceCheckpoint = 0;
+    return true;
+}
+
+// restores the dataset, the layer and the offset from the checkpoint, returns false if it's missing or invalid
+bool SiteEventConsumer::restore() {
+    std::ifstream file(m_checkpointFilename);
+    std::string header, key;
+    std::uint64_t offset = 0, token = 0;
+    std::size_t count = 0;
+    if (!std::getline(file, header) || header != kCheckpointHeader) return false;
+    if (!(file >> key >> offset) || key != "offset" || !(file >> key >> std::hex >> token >> std::dec) || key != "token") return false;
+    std::vector<Point_2> boundary;
+    if (!(file >> key >> count) || key != "boundary") return false;
+    for (std::size_t i = 0; i < count; i++) {
+        double x, y;
+        if (!(file >> x >> y)) return false;
+        boundary.push_back(Point_2(x, y));
+    }
+    SiteLayer layer;
+    if (!(file >> key >> count) || key != "sites") return false;
+    for (std::size_t i = 0; i < count; i++) {
+        std::string id;
+        double x, y;
+        if (!(file >> id >> x >> y)) return false;
+        layer.sites[id] = Point_2(x, y);
+    }
+
+    // the triangulation and the candidate tables are mapped back from the snapshot instead of being computed
+    LargestEmptyCircleStages stages;
+    if (!readSnapshot(getCheckpointSnapshotFilename(m_checkpointFilename, token), token, stages)) return false;
+    m_dataset = makeDataset(m_name, stages, m_options.threads);
+    m_boundary = std::move(boundary);
+    m_layer = std::move(layer);
+    m_offset = offset;
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef SITE_EVENT_LOG_H
+#define SITE_EVENT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "datasetStore.h"
+#include "siteLayer.h"
+
+// the site event log is an append-only text file with one event per line, ids without spaces:
+//   open ID X Y    a site opens (or moves, if the id was already open)
+//   move ID X Y    a site moves
+//   close ID       a site closes
+// the ids are the ones of the features of the sites file (like "node/123"), so the log continues the file. A line that
+// doesn't end in a line break yet is being written and is read later
+
+// event of the log
+struct SiteEvent {
+    enum Type { Open, Move, Close };
+    Type type = Open;
+    std::string id;
+    // the position of an open or a move
+    Point_2 point;
+};
+
+// function that reads the complete lines of the log from offset (in bytes) to its end, at most maxEvents of them, and
+// moves offset after the last one that was read, throws std::runtime_error if a line is malformed or the log is
+// shorter than offset (it was truncated or replaced). If malformed isn't null a malformed line is skipped instead,
+// and the error is added to it
+std::vector<SiteEvent> readSiteEvents(const std::string& filename, std::uint64_t& offset, std::size_t maxEvents = SIZE_MAX, std::vector<std::string>* malformed = nullptr);
+
+// function that appends the event to the log as one line, returns false if it can't be written
+bool appendSiteEvent(const std::string& filename, const SiteEvent& event);
+
+// function that applies the events to the layer in order (closing an id that isn't open is ignored)
+void applySiteEvents(SiteLayer& layer, const std::vector<SiteEvent>& events);
+
+// consumer of a site event log that keeps a dataset up to date: the events are applied in batches as incremental
+// updates of the triangulation, and every some events a checkpoint is written with the triangulation (a snapshot) and
+// the open sites by id up to an offset of the log, so on a restart the checkpoint is mapped back and only the events
+// after it are replayed, and the recovery takes the same time no matter how long the log is
+class SiteEventConsumer {
+public:
+    struct Options {
+        // the most events applied in one update of the triangulation
+        std::size_t batchSize = 4096;
+        // the events applied between two checkpoints (0 only writes them with checkpoint())
+        std::size_t checkpointEvents = 100000;
+        std::size_t threads = 1;
+    };
+
+    // constructor that restores the dataset from the checkpoint and replays the log after it, or, if there's no valid
+    // checkpoint, builds the dataset from the boundary and the sites files and replays the whole log (and writes a
+    // checkpoint), throws std::runtime_error if the files can't be read
+    SiteEventConsumer(const std::string& name, const std::string& boundaryFilename, const std::string& sitesFilename, const std::string& logFilename, const std::string& checkpointFilename, const Options& options);
+
+    // applies the events appended to the log since the last call, returns how many were applied (the malformed lines
+    // and the events the dataset can't take, like a close that would leave less than 3 sites, are skipped, so they
+    // don't stop the log)
+    std::size_t poll();
+
+    // writes the checkpoint of the events applied so far, returns false if it can't be written
+    bool checkpoint();
+
+    // the dataset with every event applied so far
+    std::shared_ptr<const Dataset> dataset() const { return m_dataset; }
+    // the offset of the log after the last applied event
+    std::uint64_t offset() const { return m_offset; }
+    // true if the dataset was restored from the checkpoint
+    bool restored() const { return m_restored; }
+    // the events replayed by the constructor and the time it took
+    std::size_t replayedEvents() const { return m_replayedEvents; }
+    double recoverySeconds() const { return m_recoverySeconds; }
+    // the malformed lines skipped so far and the error of the last one
+    std::size_t skippedLines() const { return m_skippedLines; }
+    const std::string& lastSkippedLine() const { return m_lastSkippedLine; }
+    // the events that couldn't be applied so far and the error of the last one
+    std::size_t skippedEvents() const { return m_skippedEvents; }
+    const std::string& lastSkippedEvent() const { return m_lastSkippedEvent; }
+
+private:
+    // restores the dataset, the layer and the offset from the checkpoint, returns false if it's missing or invalid
+    bool restore();
+    // applies one batch of events, if the batch fails its events are applied one by one and the ones that fail are
+    // skipped
+    void applyOrSkip(const std::vector<SiteEvent>& events);
+    // applies one batch of events
+    void apply(const std::vector<SiteEvent>& events);
+
+    std::string m_name;
+    std::string m_logFilename;
+    std::string m_checkpointFilename;
+    Options m_options;
+    std::shared_ptr<const Dataset> m_dataset;
+    // the points of the boundary (they are sites that never close) and the open sites by id
+    std::vector<Point_2> m_boundary;
+    SiteLayer m_layer;
+    std::uint64_t m_offset = 0;
+    std::size_t m_eventsSinceCheckpoint = 0;
+    bool m_restored = false;
+    std::size_t m_replayedEvents = 0;
+    double m_recoverySeconds = 0;
+    std::size_t m_skippedLines = 0;
+    std::string m_lastSkippedLine;
+    std::size_t m_skippedEvents = 0;
+    std::string m_lastSkippedEvent;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "siteLayer.h"
+#include "geojsonReader.h"
+#include <cstdio>
+#include <map>
+
+namespace {
+
+// function that returns the id of a feature without one from the exact bits of its coordinates ("@" and the
+// coordinates in hexadecimal floating point), so two different positions never get the same id
+std::string getCoordinateId(float x, float y) {
+    char id[64];
+    std::snprintf(id, sizeof(id), "@%a,%a", static_cast<double>(x), static_cast<double>(y));
+    return id;
+}
+
+}
+
+// function that reads the Point features of a geojson file (like readSitePoints) by their id
+SiteLayer readSiteLayer(const std::string& filename) {
+    SiteLayer layer;
+    readGeojsonFeatures(filename, [&layer](const GeojsonFeature& feature) {
+        if (feature.geometryType != "Point" || feature.coordinates.size() < 2) return;
+        // the coordinates are rounded to float like the sites of readSitePoints, so they are the same sites
+        float x = feature.coordinates[0];
+        float y = feature.coordinates[1];
+        std::string id = feature.id.empty() ? getCoordinateId(x, y) : feature.id;
+        layer.sites[id] = Point_2(x, y);
+    });
+    return layer;
+}
+
+// function that returns the changes from the layer before to the layer after, a position that is still used by
+// another feature of after or by one of the fixed points (the boundary) is not removed, since it's still a site
+SiteLayerDiff diffSiteLayers(const SiteLayer& before, const SiteLayer& after, const std::vector<Point_2>& fixedPoints) {
+    SiteLayerDiff diff;
+    // the positions that are sites after the change
+    std::map<Point_2, std::size_t> kept;
+    for (const auto& site : after.sites) kept[site.second]++;
+    for (const Point_2& point : fixedPoints) kept[point]++;
+
+    std::vector<Point_2> gone;
+    for (const auto& site : before.sites) {
+        auto now = after.sites.find(site.first);
+        if (now == after.sites.end()) {
+            diff.deletedFeatures++;
+            gone.push_back(site.second);
+        } else if (now->second != site.second) {
+            diff.movedFeatures++;
+            gone.push_back(site.second);
+            diff.inserted.push_back(now->second);
+        }
+    }
+    for (const auto& site : after.sites) {
+        if (before.sites.count(site.first) == 0) {
+            diff.addedFeatures++;
+            diff.inserted.push_back(site.second);
+        }
+    }
+    for (const Point_2& point : gone) {
+        if (kept.count(point) == 0) diff.removed.push_back(point);
+    }
+    return diff;
+}
@@ -0,0 +1,38 @@
+#ifndef SITE_LAYER_H
+#define SITE_LAYER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// the sites of a geojson file by the id of their feature, so two versions of the file can be compared feature by
+// feature: the "@id" property of the OpenStreetMap exports, or the exact coordinates of the feature if it has no id.
+// The sites are sorted by id, so the sites of a layer and the changes of a diff always come in the same order and get
+// the same site ids
+struct SiteLayer {
+    std::map<std::string, Point_2> sites;
+};
+
+// changes between two versions of a layer, as the sites to remove from the triangulation and the ones to insert (a
+// feature that moved is removed from its old position and inserted in the new one)
+struct SiteLayerDiff {
+    std::vector<Point_2> inserted;
+    std::vector<Point_2> removed;
+    // number of features added, deleted and moved
+    std::size_t addedFeatures = 0;
+    std::size_t deletedFeatures = 0;
+    std::size_t movedFeatures = 0;
+
+    bool empty() const { return inserted.empty() && removed.empty(); }
+};
+
+// function that reads the Point features of a geojson file (like readSitePoints) by their id
+SiteLayer readSiteLayer(const std::string& filename);
+
+// function that returns the changes from the layer before to the layer after, a position that is still used by
+// another feature of after or by one of the fixed points (the boundary) is not removed, since it's still a site
+SiteLayerDiff diffSiteLayers(const SiteLayer& before, const SiteLayer& after, const std::vector<Point_2>& fixedPoints = {});
+
+#endif
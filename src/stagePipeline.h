@@ -0,0 +1,145 @@
+#ifndef STAGE_PIPELINE_H
+#define STAGE_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// queue with a maximum number of items between two stages of a pipeline, a producer that finds it full waits for
+// the consumers (backpressure) so a slow stage never lets the items pile up in memory
+template <class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+    // adds an item, waiting while the queue is full
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_items.size() < m_capacity; });
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+    }
+
+    // takes the next item, returns false when the queue was finished and is empty
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_finished; });
+        if (m_items.empty()) return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // the producers call it when there are no more items
+    void finish() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+        m_notEmpty.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<T> m_items;
+    std::size_t m_capacity;
+    bool m_finished = false;
+};
+
+// pipeline of stages connected by bounded queues, every stage has its own worker threads, so while an item is in
+// a stage the next item can already be in the previous one (the reading of a region overlaps with the triangulation
+// of the one before), the items go through the stages as unique_ptr so only the pointers move between queues
+template <class T>
+class StagePipeline {
+public:
+    // function of a stage, it works on the item in place (it must not throw)
+    typedef std::function<void(T&)> Stage;
+
+    // statistics of a stage after run()
+    struct StageStatistics {
+        std::string name;
+        std::size_t workers = 0;
+        std::size_t items = 0;
+        // time the workers of the stage spent running the stage function (added over the workers)
+        double busySeconds = 0;
+    };
+
+    // constructor with the capacity of the queues between the stages
+    explicit StagePipeline(std::size_t queueCapacity = 2) : m_queueCapacity(queueCapacity) {}
+
+    // adds a stage after the previous ones, run by workers threads
+    void addStage(const std::string& name, std::size_t workers, Stage stage) {
+        StageStatistics statistics;
+        statistics.name = name;
+        statistics.workers = workers == 0 ? 1 : workers;
+        m_statistics.push_back(statistics);
+        m_stages.push_back(std::move(stage));
+    }
+
+    // makes count items with make(i) and runs them through every stage, the finished items are given to sink
+    // (on a thread of its own, one at a time) in the order they finish
+    void run(std::size_t count, const std::function<std::unique_ptr<T>(std::size_t)>& make, const std::function<void(std::unique_ptr<T>)>& sink) {
+        std::size_t numberOfStages = m_stages.size();
+        // the queue i goes into the stage i, the last one goes into the sink
+        std::vector<std::unique_ptr<BoundedQueue<std::unique_ptr<T>>>> queues;
+        for (std::size_t i = 0; i <= numberOfStages; i++) queues.emplace_back(new BoundedQueue<std::unique_ptr<T>>(m_queueCapacity));
+        std::vector<std::atomic<std::size_t>> runningWorkers(numberOfStages);
+        std::vector<std::atomic<std::size_t>> items(numberOfStages);
+        std::vector<std::atomic<long long>> busyNanoseconds(numberOfStages);
+        for (std::size_t i = 0; i < numberOfStages; i++) {
+            runningWorkers[i] = m_statistics[i].workers;
+            items[i] = 0;
+            busyNanoseconds[i] = 0;
+        }
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < numberOfStages; i++) {
+            for (std::size_t w = 0; w < m_statistics[i].workers; w++) {
+                threads.emplace_back([&, i]() {
+                    std::unique_ptr<T> item;
+                    while (queues[i]->pop(item)) {
+                        auto start = std::chrono::steady_clock::now();
+                        m_stages[i](*item);
+                        busyNanoseconds[i] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        items[i]++;
+                        queues[i + 1]->push(std::move(item));
+                    }
+                    // the last worker of the stage tells the next stage that there are no more items
+                    if (--runningWorkers[i] == 0) queues[i + 1]->finish();
+                });
+            }
+        }
+        // the sink runs on its own thread, so the first stage can be fed from this one
+        threads.emplace_back([&]() {
+            std::unique_ptr<T> item;
+            while (queues[numberOfStages]->pop(item)) sink(std::move(item));
+        });
+        for (std::size_t i = 0; i < count; i++) queues[0]->push(make(i));
+        queues[0]->finish();
+        for (std::thread& thread : threads) thread.join();
+
+        for (std::size_t i = 0; i < numberOfStages; i++) {
+            m_statistics[i].items = items[i];
+            m_statistics[i].busySeconds = busyNanoseconds[i] / 1e9;
+        }
+    }
+
+    // the statistics of every stage of the last run()
+    const std::vector<StageStatistics>& statistics() const { return m_statistics; }
+
+private:
+    std::size_t m_queueCapacity;
+    std::vector<Stage> m_stages;
+    std::vector<StageStatistics> m_statistics;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "stageProfile.h"
+#include <iomanip>
+
+namespace {
+
+// function that prints the predicates of a stage that were called, with the fraction whose filter failed
+void printPredicateCounts(std::ostream& out, const char* stage, const PredicateCounts& counts) {
+    for (std::size_t i = 0; i < kCountedPredicates; i++) {
+        if (counts.calls[i] == 0) continue;
+        out << std::left << std::setw(17) << stage << std::setw(25) << getCountedPredicateName(static_cast<CountedPredicate>(i)) << std::right << std::setw(14) << counts.calls[i]
+            << std::setw(14) << counts.filterFailures[i] << std::setw(11) << 100.0 * counts.filterFailures[i] / counts.calls[i] << "%\n";
+    }
+}
+
+}
+
+// function that prints the profile as a table with a line per stage
+void printStageProfile(std::ostream& out, const StageProfile& profile) {
+    if (!kStageProfileEnabled) {
+        out << "The profile was not compiled in (build with -DLEC_PROFILE=ON)" << std::endl;
+        return;
+    }
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(6);
+    out << "stage                 seconds  counters\n";
+    out << "triangulation    " << std::setw(12) << profile.triangulationSeconds << "  " << profile.sitesInserted << " sites inserted, " << profile.vertices << " vertices, " << profile.faces << " faces\n";
+    out << "cropped voronoi  " << std::setw(12) << profile.voronoiSeconds << "  " << profile.voronoiSegments << " segments\n";
+    out << "convex hull      " << std::setw(12) << profile.hullSeconds << "  " << profile.hullVertices << " vertices\n";
+    out << "inside vertices  " << std::setw(12) << profile.insideVerticesSeconds << "  " << profile.voronoiVertices << " generated, " << profile.insideVertices << " kept, " << profile.voronoiVertices - profile.insideVertices << " filtered\n";
+    out << "intersections    " << std::setw(12) << profile.intersectionSeconds << "  " << profile.boxTests << " box tests, " << profile.intersectionTests << " intersection tests, " << profile.hullIntersections << " found\n";
+    out << "scores           " << std::setw(12) << profile.scoreSeconds << "  " << profile.nearestVertexWalks << " nearest vertex walks, " << profile.walkSteps << " steps\n";
+    out << "pick             " << std::setw(12) << profile.pickSeconds << '\n';
+    if (kPredicateCountersEnabled) {
+        out << std::setprecision(3);
+        out << "stage            predicate                         calls  filter fails   failed\n";
+        printPredicateCounts(out, "triangulation", profile.triangulationPredicates);
+        printPredicateCounts(out, "convex hull", profile.hullPredicates);
+        printPredicateCounts(out, "inside vertices", profile.insideVerticesPredicates);
+        printPredicateCounts(out, "intersections", profile.intersectionPredicates);
+        printPredicateCounts(out, "scores", profile.scorePredicates);
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
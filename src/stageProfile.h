@@ -0,0 +1,84 @@
+#ifndef STAGE_PROFILE_H
+#define STAGE_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "predicateCounters.h"
+
+// the profile of the stages is compiled in only with LEC_PROFILE (cmake -DLEC_PROFILE=ON): without it the timers and
+// the counting code are removed by the preprocessor, so the stages run exactly as before and the profile stays zero.
+// The predicate counters go into the profile, so they turn it on
+#if defined(LEC_COUNT_PREDICATES) && !defined(LEC_PROFILE)
+#define LEC_PROFILE
+#endif
+
+#ifdef LEC_PROFILE
+// the code inside is only compiled with the profile
+#define LEC_PROFILE_ONLY(...) __VA_ARGS__
+// times the rest of the scope into the double pointed to by seconds (nothing if it's null)
+#define LEC_PROFILE_SCOPE(seconds) ScopedStageTimer LEC_PROFILE_NAME(stageTimer, __LINE__)(seconds)
+#define LEC_PROFILE_NAME(name, line) LEC_PROFILE_JOIN(name, line)
+#define LEC_PROFILE_JOIN(name, line) name##line
+const bool kStageProfileEnabled = true;
+#else
+#define LEC_PROFILE_ONLY(...)
+#define LEC_PROFILE_SCOPE(seconds)
+const bool kStageProfileEnabled = false;
+#endif
+
+// times and counters of the stages of one largest empty circle computation
+struct StageProfile {
+    // 1- triangulation and cropped Voronoi diagram
+    double triangulationSeconds = 0;
+    double voronoiSeconds = 0;
+    std::uint64_t sitesInserted = 0;
+    // the vertices can be less than the sites inserted if some of them are repeated
+    std::uint64_t vertices = 0;
+    std::uint64_t faces = 0;
+    std::uint64_t voronoiSegments = 0;
+    // 2- convex hull
+    double hullSeconds = 0;
+    std::uint64_t hullVertices = 0;
+    // 3- candidate points: the different vertices of the Voronoi segments, the ones inside the convex hull (the
+    // others are filtered out), the pairs of a Voronoi segment and a hull edge whose boxes were compared, the pairs
+    // whose boxes overlap (the intersection tests) and the intersections found
+    double insideVerticesSeconds = 0;
+    double intersectionSeconds = 0;
+    std::uint64_t voronoiVertices = 0;
+    std::uint64_t insideVertices = 0;
+    std::uint64_t boxTests = 0;
+    std::uint64_t intersectionTests = 0;
+    std::uint64_t hullIntersections = 0;
+    // 4- scores: a walk to the nearest site for every candidate, and the steps of all the walks
+    double scoreSeconds = 0;
+    double pickSeconds = 0;
+    std::uint64_t nearestVertexWalks = 0;
+    std::uint64_t walkSteps = 0;
+    // the predicates called by the stages and how many times their filter failed (only with LEC_COUNT_PREDICATES)
+    PredicateCounts triangulationPredicates;
+    PredicateCounts hullPredicates;
+    PredicateCounts insideVerticesPredicates;
+    PredicateCounts intersectionPredicates;
+    PredicateCounts scorePredicates;
+};
+
+// timer that writes the seconds from its construction to its destruction
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(double* seconds) : m_seconds(seconds), m_start(std::chrono::steady_clock::now()) {}
+    ~ScopedStageTimer() {
+        if (m_seconds) *m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    double* m_seconds;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// function that prints the profile as a table with a line per stage
+void printStageProfile(std::ostream& out, const StageProfile& profile);
+
+#endif
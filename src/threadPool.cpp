@@ -0,0 +1,179 @@
+#include "threadPool.h"
+#include "predicateCounters.h"
+#include <algorithm>
+#include <exception>
+#include <pthread.h>
+
+// constructor that starts the workers, by default one per hardware thread
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (std::size_t i = 0; i < threads; i++) m_workers.emplace_back(new Worker());
+    for (std::size_t i = 0; i < threads; i++) m_threads.emplace_back(&ThreadPool::run, this, i);
+}
+
+// waits for the pending tasks and stops the workers
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+// adds a task, the tasks are spread over the deques of the workers in round robin
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending++;
+    }
+    Worker& worker = *m_workers[m_nextWorker++ % m_workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    m_queued++;
+    // the lock makes sure a worker that is about to sleep sees the new task
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wakeUp.notify_one();
+}
+
+// waits until every submitted task has finished
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+// takes a task from the own deque or steals one from the others, returns false if every deque is empty
+bool ThreadPool::takeTask(std::size_t self, std::function<void()>& task) {
+    for (std::size_t i = 0; i < m_workers.size(); i++) {
+        // the own deque first, then the next workers in order
+        Worker& worker = *m_workers[(self + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// body of the worker threads
+void ThreadPool::run(std::size_t self) {
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(self, task)) {
+            task();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) m_done.notify_all();
+            continue;
+        }
+        // without tasks the worker sleeps until there is a new one or the pool stops
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this] { return m_stopping || m_queued > 0; });
+        if (m_stopping && m_queued == 0) return;
+    }
+}
+
+namespace {
+
+// a call of parallelFor shared with the tasks of its helpers, which can start after the call returned (they find it
+// closed and do nothing, so they never touch the body)
+struct ParallelForCall {
+    std::size_t count = 0;
+    std::size_t chunkSize = 1;
+    std::size_t chunks = 0;
+    const std::function<void(std::size_t, std::size_t, std::size_t)>* body = nullptr;
+    // the chunks are taken in order from a shared counter
+    std::atomic<std::size_t> nextChunk{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    // helpers running chunks, and if the call stopped taking helpers
+    std::size_t running = 0;
+    bool closed = false;
+    // the first exception thrown by the body, the chunks not started yet are skipped
+    std::exception_ptr error;
+    // the predicates counted by the helpers
+    LEC_COUNT_PREDICATES_ONLY(PredicateCounts helperCounts;)
+
+    // runs chunks until there are no more
+    void runChunks() {
+        std::size_t chunk;
+        while ((chunk = nextChunk++) < chunks) {
+            std::size_t begin = chunk * chunkSize;
+            try {
+                (*body)(begin, std::min(count, begin + chunkSize), chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                nextChunk = chunks;
+            }
+        }
+    }
+};
+
+// true in a child process forked by this one, whose pool has no workers (only the thread that forked is copied)
+std::atomic<bool> forkedChild{false};
+
+// function that returns the pool whose workers help every call of parallelFor, started on the first call with one
+// worker per hardware thread
+ThreadPool& getParallelForPool() {
+    // never destroyed, so a thread still in a call when the program exits doesn't find it stopped
+    static ThreadPool* pool = []() {
+        pthread_atfork(nullptr, nullptr, []() { forkedChild = true; });
+        return new ThreadPool();
+    }();
+    return *pool;
+}
+
+}
+
+// function that splits [0, count) in chunks of chunkSize elements and runs body(begin, end, chunkIndex) for every chunk
+// on the calling thread and up to threads - 1 workers of a pool shared by every call (the pool isn't used with one
+// thread or in a forked child). The chunks don't depend on the number of threads, so a body that only depends on its
+// chunk gives the same results with any number of threads. The calling thread only waits for the helpers that started
+// running chunks, so a call from inside a chunk of another call can't wait for a helper stuck behind it in the pool.
+// The first exception thrown by the body is thrown again once the running chunks finish
+void parallelFor(std::size_t count, std::size_t chunkSize, std::size_t threads, const std::function<void(std::size_t, std::size_t, std::size_t)>& body) {
+    if (chunkSize == 0) chunkSize = 1;
+    std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    threads = std::min(threads, chunks);
+    std::shared_ptr<ParallelForCall> call = std::make_shared<ParallelForCall>();
+    call->count = count;
+    call->chunkSize = chunkSize;
+    call->chunks = chunks;
+    call->body = &body;
+    if (threads > 1 && !forkedChild) {
+        ThreadPool& pool = getParallelForPool();
+        // more helpers than workers would only wait in the deques
+        for (std::size_t i = 1; i < std::min(threads, pool.size() + 1); i++) {
+            pool.submit([call]() {
+                {
+                    std::lock_guard<std::mutex> lock(call->mutex);
+                    if (call->closed) return;
+                    call->running++;
+                }
+                // the worker keeps its own counters, only the ones of this call are added to the calling thread
+                LEC_COUNT_PREDICATES_ONLY(PredicateCounts before = getThreadPredicateCounts();)
+                call->runChunks();
+                std::lock_guard<std::mutex> lock(call->mutex);
+                LEC_COUNT_PREDICATES_ONLY(call->helperCounts += getThreadPredicateCounts() - before;)
+                if (--call->running == 0) call->finished.notify_all();
+            });
+        }
+    }
+    call->runChunks();
+    std::unique_lock<std::mutex> lock(call->mutex);
+    call->closed = true;
+    call->finished.wait(lock, [&call] { return call->running == 0; });
+    // the predicates counted by the helpers are added to the calling thread, so they count in its stage
+    LEC_COUNT_PREDICATES_ONLY(getThreadPredicateCounts() += call->helperCounts;)
+    if (call->error) std::rethrow_exception(call->error);
+}
@@ -0,0 +1,69 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// pool of worker threads with one task deque per worker, a worker that runs out of tasks steals from the others,
+// the tasks of every deque are taken in submission order, so if the tasks are submitted from the biggest to the
+// smallest the biggest ones start first (in the own deque and when stealing)
+class ThreadPool {
+public:
+    // constructor that starts the workers, by default one per hardware thread
+    explicit ThreadPool(std::size_t threads = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // waits for the pending tasks and stops the workers
+    ~ThreadPool();
+
+    // adds a task, the tasks are spread over the deques of the workers in round robin (a task must not throw)
+    void submit(std::function<void()> task);
+
+    // waits until every submitted task has finished
+    void wait();
+
+    // the number of workers
+    std::size_t size() const { return m_workers.size(); }
+
+private:
+    // deque of tasks of a worker
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // takes a task from the own deque or steals one from the others, returns false if every deque is empty
+    bool takeTask(std::size_t self, std::function<void()>& task);
+    // body of the worker threads
+    void run(std::size_t self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    // the next deque for submit()
+    std::atomic<std::size_t> m_nextWorker{0};
+    // tasks waiting in the deques and tasks not finished yet
+    std::atomic<std::size_t> m_queued{0};
+    std::size_t m_pending = 0;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_done;
+};
+
+// function that splits [0, count) in chunks of chunkSize elements and runs body(begin, end, chunkIndex) for every chunk
+// on the calling thread and up to threads - 1 workers of a pool shared by every call (started on the first call, so
+// no thread is created per call), the chunks don't depend on the number of threads, so a body that only depends on
+// its chunk gives the same results with any number of threads. It can be called from inside a chunk, and the first
+// exception thrown by the body is thrown again once the running chunks finish
+void parallelFor(std::size_t count, std::size_t chunkSize, std::size_t threads, const std::function<void(std::size_t, std::size_t, std::size_t)>& body);
+
+#endif
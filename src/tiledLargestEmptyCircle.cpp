@@ -0,0 +1,242 @@
+#include "tiledLargestEmptyCircle.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// the sites sorted by the tile they fall in, the sites of the tile i are sites[tileStart[i]] to sites[tileStart[i + 1] - 1]
+struct TileBuckets {
+    std::vector<std::size_t> tileStart;
+    std::vector<Point_2> sites;
+};
+
+// function that sorts the sites in the tiles of the grid (counting sort)
+TileBuckets buildTileBuckets(const std::vector<Point_2>& points, const TileGrid& tileGrid) {
+    TileBuckets buckets;
+    std::vector<std::size_t> tiles(points.size());
+    buckets.tileStart.assign(tileGrid.size() + 1, 0);
+    for (std::size_t i = 0; i < points.size(); i++) {
+        tiles[i] = tileGrid.getTileIndex(points[i]);
+        buckets.tileStart[tiles[i] + 1]++;
+    }
+    for (std::size_t i = 1; i < buckets.tileStart.size(); i++) buckets.tileStart[i] += buckets.tileStart[i - 1];
+    std::vector<std::size_t> next(buckets.tileStart.begin(), buckets.tileStart.end() - 1);
+    buckets.sites.resize(points.size());
+    for (std::size_t i = 0; i < points.size(); i++) buckets.sites[next[tiles[i]]++] = points[i];
+    return buckets;
+}
+
+// function that returns the sites of the buckets inside the rectangle
+std::vector<Point_2> getSitesInside(const TileBuckets& buckets, const TileGrid& tileGrid, const Iso_rectangle_2& rectangle) {
+    std::vector<Point_2> sites;
+    double xmin = CGAL::to_double(rectangle.xmin()), ymin = CGAL::to_double(rectangle.ymin());
+    double xmax = CGAL::to_double(rectangle.xmax()), ymax = CGAL::to_double(rectangle.ymax());
+    // only the tiles that overlap the rectangle are visited
+    for (std::size_t row = tileGrid.getRow(ymin); row <= tileGrid.getRow(ymax); row++) {
+        for (std::size_t column = tileGrid.getColumn(xmin); column <= tileGrid.getColumn(xmax); column++) {
+            std::size_t tile = row * tileGrid.tilesPerSide + column;
+            for (std::size_t i = buckets.tileStart[tile]; i < buckets.tileStart[tile + 1]; i++) {
+                double x = CGAL::to_double(buckets.sites[i].x()), y = CGAL::to_double(buckets.sites[i].y());
+                if (x >= xmin && x <= xmax && y >= ymin && y <= ymax) sites.push_back(buckets.sites[i]);
+            }
+        }
+    }
+    return sites;
+}
+
+// function that clamps a (fractional) column or row to the grid
+std::size_t clampCell(double cell, std::size_t tilesPerSide) {
+    if (!(cell > 0)) return 0;
+    return std::min(tilesPerSide - 1, static_cast<std::size_t>(cell));
+}
+
+}
+
+// the column and the row of the tile of a coordinate (clamped to the grid)
+std::size_t TileGrid::getColumn(double x) const { return clampCell((x - minX) / tileWidth, tilesPerSide); }
+std::size_t TileGrid::getRow(double y) const { return clampCell((y - minY) / tileHeight, tilesPerSide); }
+
+// the tile of a point
+std::size_t TileGrid::getTileIndex(const Point_2& point) const {
+    return getRow(CGAL::to_double(point.y())) * tilesPerSide + getColumn(CGAL::to_double(point.x()));
+}
+
+// the rectangle of a tile
+Iso_rectangle_2 TileGrid::getTile(std::size_t tile) const {
+    // the last tiles end exactly on the biggest coordinates, so no site is left out by a rounding
+    std::size_t column = tile % tilesPerSide, row = tile / tilesPerSide;
+    double xmin = minX + column * tileWidth;
+    double ymin = minY + row * tileHeight;
+    double xmax = column + 1 == tilesPerSide ? std::max(maxX, xmin + tileWidth) : minX + (column + 1) * tileWidth;
+    double ymax = row + 1 == tilesPerSide ? std::max(maxY, ymin + tileHeight) : minY + (row + 1) * tileHeight;
+    return Iso_rectangle_2(xmin, ymin, xmax, ymax);
+}
+
+// function that returns a grid with tilesPerSide tiles on each side over the bounding box
+TileGrid makeTileGrid(double minX, double minY, double maxX, double maxY, std::size_t tilesPerSide) {
+    TileGrid tileGrid;
+    tileGrid.minX = minX;
+    tileGrid.minY = minY;
+    tileGrid.maxX = maxX;
+    tileGrid.maxY = maxY;
+    tileGrid.tilesPerSide = std::max<std::size_t>(1, tilesPerSide);
+    // a grid over sites on a line still needs tiles with some size
+    tileGrid.tileWidth = maxX > minX ? (maxX - minX) / tileGrid.tilesPerSide : 1;
+    tileGrid.tileHeight = maxY > minY ? (maxY - minY) / tileGrid.tilesPerSide : 1;
+    return tileGrid;
+}
+
+// function that returns a grid with tilesPerSide tiles on each side over the bounding box of the points
+TileGrid makeTileGrid(const std::vector<Point_2>& points, std::size_t tilesPerSide) {
+    double minX = CGAL::to_double(points[0].x()), maxX = minX;
+    double minY = CGAL::to_double(points[0].y()), maxY = minY;
+    for (const Point_2& point : points) {
+        minX = std::min(minX, CGAL::to_double(point.x()));
+        minY = std::min(minY, CGAL::to_double(point.y()));
+        maxX = std::max(maxX, CGAL::to_double(point.x()));
+        maxY = std::max(maxY, CGAL::to_double(point.y()));
+    }
+    return makeTileGrid(minX, minY, maxX, maxY, tilesPerSide);
+}
+
+// function that solves a tile (core) with the sites inside the tile plus its halo, the convex hull of all the sites
+// and its edges, keeping the k largest circles of the tile
+TileResult solveLargestEmptyCircleTile(const std::vector<Point_2>& haloSites, const Iso_rectangle_2& core, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, std::size_t k) {
+    TileResult result;
+
+    // the parts of the edges of the convex hull inside the tile
+    std::vector<Segment_2> coreChSegments;
+    std::vector<Point_2> candidatePoints;
+    for (const Segment_2& chSegment : chSegments) {
+        CGAL::Object obj = CGAL::intersection(chSegment, core);
+        if (const Segment_2* s = CGAL::object_cast<Segment_2>(&obj)) {
+            coreChSegments.push_back(*s);
+            // the ends of the part are where the convex hull enters and leaves the tile
+            candidatePoints.push_back(s->source());
+            candidatePoints.push_back(s->target());
+        } else if (const Point_2* p = CGAL::object_cast<Point_2>(&obj)) {
+            candidatePoints.push_back(*p);
+        }
+    }
+    // the corners of the tile inside the convex hull
+    for (int i = 0; i < 4; i++) {
+        if (!ch.has_on_unbounded_side(core.vertex(i))) candidatePoints.push_back(core.vertex(i));
+    }
+
+    // the local triangulation and its Voronoi diagram cropped to the tile, whose ends are the Voronoi vertices
+    // and the intersections with the sides of the tile
+    Delaunay_triangulation_2 dt2;
+    triangulate(dt2, haloSites);
+    std::list<Segment_2> voronoiSegments = getCroppedVoronoi(dt2, core);
+    std::vector<Point_2> voronoiCandidates = getCandidatePoints(voronoiSegments, ch, coreChSegments);
+    candidatePoints.insert(candidatePoints.end(), voronoiCandidates.begin(), voronoiCandidates.end());
+    if (candidatePoints.empty()) return result;
+
+    // without local sites nothing of the tile can be known
+    if (dt2.number_of_vertices() == 0) {
+        result.maxSquaredRadius = std::numeric_limits<double>::infinity();
+        return result;
+    }
+    std::vector<K::FT> candidateScores = scoreCandidatePoints(dt2, candidatePoints);
+    for (const K::FT& score : candidateScores) result.maxSquaredRadius = std::max(result.maxSquaredRadius, CGAL::to_double(score));
+    result.circles = pickLargestEmptyCircles(candidatePoints, candidateScores, k);
+    return result;
+}
+
+// function that solves a tile of the grid growing its halo (starting from firstHalo) until its circles are exact,
+// getSites returns the sites inside a rectangle, and adds the number of grown halos to haloExpansions
+TileResult solveLargestEmptyCircleTileWithHalo(const TileGrid& tileGrid, std::size_t tile, const std::function<std::vector<Point_2>(const Iso_rectangle_2&)>& getSites, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, double firstHalo, std::size_t& haloExpansions, std::size_t k) {
+    double width = std::max(tileGrid.maxX - tileGrid.minX, tileGrid.tileWidth);
+    double height = std::max(tileGrid.maxY - tileGrid.minY, tileGrid.tileHeight);
+    Iso_rectangle_2 core = tileGrid.getTile(tile);
+    double xmin = CGAL::to_double(core.xmin()), ymin = CGAL::to_double(core.ymin());
+    double xmax = CGAL::to_double(core.xmax()), ymax = CGAL::to_double(core.ymax());
+    double halo = firstHalo;
+    while (true) {
+        Iso_rectangle_2 expanded(xmin - halo, ymin - halo, xmax + halo, ymax + halo);
+        // a halo that covers every site always gives the real circles
+        bool covering = xmin - halo <= tileGrid.minX && ymin - halo <= tileGrid.minY && xmax + halo >= tileGrid.maxX && ymax + halo >= tileGrid.maxY;
+        TileResult result = solveLargestEmptyCircleTile(getSites(expanded), core, ch, chSegments, k);
+        if (covering || result.maxSquaredRadius <= halo * halo) return result;
+        // the halo is grown at least to the biggest local radius
+        halo = std::max(2 * halo, std::sqrt(result.maxSquaredRadius));
+        if (std::isinf(halo)) halo = 2 * std::max(width, height);
+        haloExpansions++;
+    }
+}
+
+// function that solves every tile of the grid at the same time with the sites in memory, growing the halo of a tile
+// (starting from firstHalo) until its circles are exact, and adds the number of grown halos to haloExpansions (the
+// cancellation token, if any, is checked before every tile and OperationCancelled is thrown when it stops the
+// computation)
+std::vector<TileResult> solveLargestEmptyCircleTiles(const std::vector<Point_2>& sites, const TileGrid& tileGrid, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, double firstHalo, std::size_t threads, std::size_t& haloExpansions, std::size_t k, const CancellationToken* cancellation) {
+    TileBuckets buckets = buildTileBuckets(sites, tileGrid);
+    auto getSites = [&buckets, &tileGrid](const Iso_rectangle_2& rectangle) { return getSitesInside(buckets, tileGrid, rectangle); };
+
+    std::vector<TileResult> results(tileGrid.size());
+    std::vector<std::size_t> expansions(tileGrid.size(), 0);
+    parallelFor(tileGrid.size(), 1, threads, [&](std::size_t tile, std::size_t, std::size_t) {
+        if (cancellation && cancellation->shouldStop()) return;
+        results[tile] = solveLargestEmptyCircleTileWithHalo(tileGrid, tile, getSites, ch, chSegments, firstHalo, expansions[tile], k);
+    });
+    if (cancellation) cancellation->check();
+    for (std::size_t count : expansions) haloExpansions += count;
+    return results;
+}
+
+// function that adds the circles to the k best circles (sorted from the best), skipping repeated centers
+void mergeLargestEmptyCircles(std::vector<LargestEmptyCircle>& best, const std::vector<LargestEmptyCircle>& circles, std::size_t k) {
+    for (const LargestEmptyCircle& circle : circles) {
+        // a point on the side of two tiles is a candidate of both
+        bool repeated = false;
+        for (const LargestEmptyCircle& other : best) repeated = repeated || other.center == circle.center;
+        if (repeated) continue;
+        if (best.size() == k && (k == 0 || !isBetterCircle(circle, best.back()))) continue;
+        best.insert(std::upper_bound(best.begin(), best.end(), circle, isBetterCircle), circle);
+        if (best.size() > k) best.pop_back();
+    }
+}
+
+// function that returns the largest empty circle of the points solving the tiles of a grid at the same time,
+// the circle is the same as the one of getLargestEmptyCircle (on a tie of the radius the center may be another
+// point with the same radius)
+TiledLargestEmptyCircle getTiledLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const TiledLargestEmptyCircleOptions& options) {
+    TiledLargestEmptyCircle tiled;
+    if (inputPointsCGAL.empty()) return tiled;
+
+    std::size_t threads = options.threads;
+    if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::size_t tilesPerSide = options.tilesPerSide;
+    if (tilesPerSide == 0) tilesPerSide = static_cast<std::size_t>(std::ceil(std::sqrt(8.0 * threads)));
+    TileGrid tileGrid = makeTileGrid(inputPointsCGAL, tilesPerSide);
+    tiled.tiles = tileGrid.size();
+
+    // the convex hull is the convex hull of the convex hulls of the tiles
+    TileBuckets buckets = buildTileBuckets(inputPointsCGAL, tileGrid);
+    std::vector<std::vector<Point_2>> tileChVertices(tileGrid.size());
+    parallelFor(tileGrid.size(), 1, threads, [&](std::size_t tile, std::size_t, std::size_t) {
+        std::vector<Point_2> tileSites(buckets.sites.begin() + buckets.tileStart[tile], buckets.sites.begin() + buckets.tileStart[tile + 1]);
+        if (tileSites.empty()) return;
+        Polygon_2 tileCh = getConvexHull(tileSites);
+        tileChVertices[tile].assign(tileCh.vertices_begin(), tileCh.vertices_end());
+    });
+    std::vector<Point_2> chVertices;
+    for (const std::vector<Point_2>& vertices : tileChVertices) chVertices.insert(chVertices.end(), vertices.begin(), vertices.end());
+    Polygon_2 ch = getConvexHull(chVertices);
+    std::vector<Segment_2> chSegments = getPolygonSegments(ch);
+
+    // the first halo is some mean distances between sites
+    double width = std::max(tileGrid.maxX - tileGrid.minX, tileGrid.tileWidth);
+    double height = std::max(tileGrid.maxY - tileGrid.minY, tileGrid.tileHeight);
+    double firstHalo = options.haloFactor * std::sqrt(width * height / inputPointsCGAL.size());
+    if (options.cancellation) options.cancellation->check();
+    std::vector<TileResult> results = solveLargestEmptyCircleTiles(inputPointsCGAL, tileGrid, ch, chSegments, firstHalo, threads, tiled.haloExpansions, 1, options.cancellation);
+
+    // the circle is the best circle of the tiles
+    std::vector<LargestEmptyCircle> best;
+    for (const TileResult& result : results) mergeLargestEmptyCircles(best, result.circles, 1);
+    if (!best.empty()) tiled.circle = best[0];
+    return tiled;
+}
@@ -0,0 +1,97 @@
+#ifndef TILED_LARGEST_EMPTY_CIRCLE_H
+#define TILED_LARGEST_EMPTY_CIRCLE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "cancellation.h"
+#include "largestEmptyCircle.h"
+
+// the tiled mode splits the bounding box of the sites in a grid of tiles and solves every tile on its own with the
+// sites of the tile plus the sites of a halo around it, so the tiles can be triangulated at the same time
+//
+// why the halo makes it exact: the local distance to the nearest site (with only the sites of the tile and its halo)
+// is never smaller than the real one, so if no point of the tile is farther than the halo from its nearest local
+// site, the nearest local site of every point of the tile is at most at halo distance and the whole circle is inside
+// the tile plus its halo, where every site is known, so the local circles are the real ones. The largest local
+// distance in the tile is found scoring the vertices of the local Voronoi diagram cropped to the tile, its
+// intersections with the sides of the tile and the convex hull, and the corners of the tile inside the convex hull.
+// If it's bigger than the halo the halo is doubled (or grown to it) and the tile is solved again
+
+// options of the tiled largest empty circle
+struct TiledLargestEmptyCircleOptions {
+    // number of threads (0 is one per hardware thread)
+    std::size_t threads = 0;
+    // number of tiles on each side of the grid (0 picks enough tiles for 8 per thread)
+    std::size_t tilesPerSide = 0;
+    // first halo around every tile, in mean distances between sites (the sqrt of the area per site)
+    double haloFactor = 4;
+    // token checked before every tile (OperationCancelled is thrown when it stops the computation), null if the
+    // computation can't be cancelled
+    const CancellationToken* cancellation = nullptr;
+};
+
+// grid of tiles over the bounding box of the sites, the last tiles end exactly on the biggest coordinates
+struct TileGrid {
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    std::size_t tilesPerSide = 1;
+    double tileWidth = 1, tileHeight = 1;
+
+    // the number of tiles
+    std::size_t size() const { return tilesPerSide * tilesPerSide; }
+    // the column and the row of the tile of a coordinate (clamped to the grid)
+    std::size_t getColumn(double x) const;
+    std::size_t getRow(double y) const;
+    // the tile of a point
+    std::size_t getTileIndex(const Point_2& point) const;
+    // the rectangle of a tile
+    Iso_rectangle_2 getTile(std::size_t tile) const;
+};
+
+// function that returns a grid with tilesPerSide tiles on each side over the bounding box
+TileGrid makeTileGrid(double minX, double minY, double maxX, double maxY, std::size_t tilesPerSide);
+
+// function that returns a grid with tilesPerSide tiles on each side over the bounding box of the points (not empty)
+TileGrid makeTileGrid(const std::vector<Point_2>& points, std::size_t tilesPerSide);
+
+// result of a tile solved with the sites of the tile and its halo
+struct TileResult {
+    // the largest empty circles centered in the tile, from the biggest to the smallest (empty if the tile is
+    // outside the convex hull)
+    std::vector<LargestEmptyCircle> circles;
+    // the biggest squared distance from a point of the tile inside the convex hull to its nearest local site,
+    // infinite if there are no local sites
+    double maxSquaredRadius = 0;
+};
+
+// result of the tiled largest empty circle
+struct TiledLargestEmptyCircle {
+    LargestEmptyCircle circle;
+    // number of tiles and number of times a halo had to be grown
+    std::size_t tiles = 0;
+    std::size_t haloExpansions = 0;
+};
+
+// function that solves a tile (core) with the sites inside the tile plus its halo, the convex hull of all the sites
+// and its edges, keeping the k largest circles of the tile
+TileResult solveLargestEmptyCircleTile(const std::vector<Point_2>& haloSites, const Iso_rectangle_2& core, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, std::size_t k = 1);
+
+// function that solves a tile of the grid growing its halo (starting from firstHalo) until its circles are exact,
+// getSites returns the sites inside a rectangle, and adds the number of grown halos to haloExpansions
+TileResult solveLargestEmptyCircleTileWithHalo(const TileGrid& tileGrid, std::size_t tile, const std::function<std::vector<Point_2>(const Iso_rectangle_2&)>& getSites, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, double firstHalo, std::size_t& haloExpansions, std::size_t k = 1);
+
+// function that solves every tile of the grid at the same time with the sites in memory, growing the halo of a tile
+// (starting from firstHalo) until its circles are exact, and adds the number of grown halos to haloExpansions (the
+// cancellation token, if any, is checked before every tile and OperationCancelled is thrown when it stops the
+// computation)
+std::vector<TileResult> solveLargestEmptyCircleTiles(const std::vector<Point_2>& sites, const TileGrid& tileGrid, const Polygon_2& ch, const std::vector<Segment_2>& chSegments, double firstHalo, std::size_t threads, std::size_t& haloExpansions, std::size_t k = 1, const CancellationToken* cancellation = nullptr);
+
+// function that adds the circles to the k best circles (sorted from the best), skipping repeated centers
+void mergeLargestEmptyCircles(std::vector<LargestEmptyCircle>& best, const std::vector<LargestEmptyCircle>& circles, std::size_t k);
+
+// function that returns the largest empty circle of the points solving the tiles of a grid at the same time,
+// the circle is the same as the one of getLargestEmptyCircle (on a tie of the radius the center may be another
+// point with the same radius)
+TiledLargestEmptyCircle getTiledLargestEmptyCircle(const std::vector<Point_2>& inputPointsCGAL, const TiledLargestEmptyCircleOptions& options = TiledLargestEmptyCircleOptions());
+
+#endif
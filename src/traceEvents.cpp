@@ -0,0 +1,170 @@
+#include "traceEvents.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// span of the trace, the times are nanoseconds from the start of the trace
+struct TraceEvent {
+    std::string name;
+    const char* category = "";
+    std::string region;
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+};
+
+// block of spans of a thread, the spans never move once they are written so the block is read while it's filled:
+// only the spans below count are complete
+struct TraceBlock {
+    static const std::size_t kSize = 1024;
+    TraceEvent events[kSize];
+    std::atomic<std::size_t> count{0};
+    std::atomic<TraceBlock*> next{nullptr};
+};
+
+// spans of a thread, only the thread writes them, and the list of buffers only grows
+struct TraceBuffer {
+    std::uint32_t thread = 0;
+    TraceBlock* first = nullptr;
+    // the block being filled, only used by the thread
+    TraceBlock* last = nullptr;
+    TraceBuffer* next = nullptr;
+};
+
+std::atomic<bool> tracing{false};
+std::string traceFilename;
+std::chrono::steady_clock::time_point traceOrigin;
+// the buffers of every thread that recorded a span, pushed at the head without locks
+std::atomic<TraceBuffer*> traceBuffers{nullptr};
+std::atomic<std::uint32_t> nextTraceThread{1};
+// only one writeTrace() at a time (the recording never takes it)
+std::mutex writeMutex;
+
+// the buffer and the region of the thread, the buffers are never freed so they outlive their threads until the trace
+// is written at exit
+thread_local TraceBuffer* threadBuffer = nullptr;
+thread_local const std::string* threadRegion = nullptr;
+
+// function that returns the buffer of the thread, created and published on its first span
+TraceBuffer* getThreadBuffer() {
+    if (threadBuffer) return threadBuffer;
+    TraceBuffer* buffer = new TraceBuffer();
+    buffer->thread = nextTraceThread.fetch_add(1, std::memory_order_relaxed);
+    buffer->first = buffer->last = new TraceBlock();
+    // the buffer is whole before it's reachable from the list
+    buffer->next = traceBuffers.load(std::memory_order_relaxed);
+    while (!traceBuffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {}
+    threadBuffer = buffer;
+    return buffer;
+}
+
+// function that appends a span to the buffer of the thread
+void recordSpan(std::string&& name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    TraceBuffer* buffer = getThreadBuffer();
+    TraceBlock* block = buffer->last;
+    std::size_t count = block->count.load(std::memory_order_relaxed);
+    if (count == TraceBlock::kSize) {
+        TraceBlock* next = new TraceBlock();
+        block->next.store(next, std::memory_order_release);
+        buffer->last = block = next;
+        count = 0;
+    }
+    TraceEvent& event = block->events[count];
+    event.name = std::move(name);
+    event.category = category;
+    event.region = threadRegion ? *threadRegion : std::string();
+    event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - traceOrigin).count();
+    event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    // the span is complete before the writer can see it
+    block->count.store(count + 1, std::memory_order_release);
+}
+
+// writes the trace when the program exits
+void writeTraceAtExit() {
+    writeTrace();
+}
+
+}
+
+// starts recording the spans of every thread, they are written to filename at exit (or by writeTrace())
+void startTrace(const std::string& filename) {
+    if (tracing.load()) return;
+    traceFilename = filename;
+    traceOrigin = std::chrono::steady_clock::now();
+    std::atexit(writeTraceAtExit);
+    tracing.store(true);
+}
+
+// true if the spans are being recorded
+bool isTracing() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+// writes the spans recorded so far to the file of startTrace() as Chrome trace event JSON, returns false if it isn't
+// tracing or the file can't be written
+bool writeTrace() {
+    if (!tracing.load()) return false;
+    std::lock_guard<std::mutex> lock(writeMutex);
+    // the trace is written aside and renamed, so a viewer never opens half a file
+    std::string temporaryFilename = traceFilename + ".tmp";
+    std::ofstream file(temporaryFilename, std::ios::trunc);
+    if (!file) return false;
+    int pid = static_cast<int>(::getpid());
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    file << std::fixed << std::setprecision(3);
+    for (TraceBuffer* buffer = traceBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        // the name of the row of the thread
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->thread << ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+        first = false;
+        for (TraceBlock* block = buffer->first; block; block = block->next.load(std::memory_order_acquire)) {
+            std::size_t count = block->count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; i++) {
+                const TraceEvent& event = block->events[i];
+                // complete events ("X") with the times in microseconds
+                file << ",\n{\"name\":" << nlohmann::json(event.name).dump() << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start / 1000.0
+                     << ",\"dur\":" << event.duration / 1000.0 << ",\"pid\":" << pid << ",\"tid\":" << buffer->thread;
+                if (!event.region.empty()) file << ",\"args\":{\"region\":" << nlohmann::json(event.region).dump() << '}';
+                file << '}';
+            }
+        }
+    }
+    file << "\n]}\n";
+    file.close();
+    if (!file) return false;
+    return std::rename(temporaryFilename.c_str(), traceFilename.c_str()) == 0;
+}
+
+// the category groups the spans in the viewer: "region", "stage" or "request"
+TraceSpan::TraceSpan(const char* name, const char* category) : m_recording(isTracing()), m_category(category) {
+    if (!m_recording) return;
+    m_name = name;
+    m_start = std::chrono::steady_clock::now();
+}
+
+TraceSpan::TraceSpan(const std::string& name, const char* category) : m_recording(isTracing()), m_category(category) {
+    if (!m_recording) return;
+    m_name = name;
+    m_start = std::chrono::steady_clock::now();
+}
+
+TraceSpan::~TraceSpan() {
+    if (m_recording) recordSpan(std::move(m_name), m_category, m_start, std::chrono::steady_clock::now());
+}
+
+// the name is only kept while tracing, otherwise the region costs nothing
+TraceRegion::TraceRegion(const std::string& name) : m_previous(threadRegion) {
+    if (!isTracing()) return;
+    m_name = name;
+    threadRegion = &m_name;
+}
+
+TraceRegion::~TraceRegion() {
+    threadRegion = m_previous;
+}
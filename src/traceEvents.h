@@ -0,0 +1,56 @@
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// recording of spans (a name, a start and a duration on a thread) written as Chrome trace event JSON, which
+// chrome://tracing and https://ui.perfetto.dev show as a timeline with a row per thread. Every thread appends its
+// spans to its own buffer without locks or atomic read-modify-writes, and the buffers are only read when the trace is
+// written (at exit, or by writeTrace()). Without startTrace() a span costs one relaxed atomic load
+
+// starts recording the spans of every thread, they are written to filename at exit (or by writeTrace())
+void startTrace(const std::string& filename);
+
+// true if the spans are being recorded
+bool isTracing();
+
+// writes the spans recorded so far to the file of startTrace() as Chrome trace event JSON, returns false if it isn't
+// tracing or the file can't be written
+bool writeTrace();
+
+// span that lasts from its construction to its destruction, tagged with the region of its thread (see TraceRegion)
+class TraceSpan {
+public:
+    // the category groups the spans in the viewer: "region", "stage" or "request"
+    explicit TraceSpan(const char* name, const char* category = "stage");
+    explicit TraceSpan(const std::string& name, const char* category = "stage");
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    bool m_recording;
+    std::string m_name;
+    const char* m_category;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// the region (or dataset) the spans of the thread belong to while it exists, so the stages don't need to know which
+// region they are running for; the previous region is restored when it's destroyed
+class TraceRegion {
+public:
+    explicit TraceRegion(const std::string& name);
+    ~TraceRegion();
+
+    TraceRegion(const TraceRegion&) = delete;
+    TraceRegion& operator=(const TraceRegion&) = delete;
+
+private:
+    const std::string* m_previous;
+    std::string m_name;
+};
+
+#endif
@@ -0,0 +1,314 @@
+#include "triangulationSnapshot.h"
+#include "mappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+typedef Delaunay_triangulation_2::Vertex_handle Vertex_handle;
+typedef Delaunay_triangulation_2::Face_handle Face_handle;
+
+// the first bytes of every snapshot file
+const char kSnapshotMagic[8] = {'L', 'E', 'C', 'S', 'N', 'A', 'P', '\0'};
+// value written in the native byte order, a snapshot from a machine with another byte order won't match it
+const std::uint32_t kEndianTag = 0x01020304;
+
+// header at the start of the snapshot, followed by the payload:
+// - the finite vertices as pairs of doubles (x, y)
+// - all the faces (infinite ones included) as 3 vertex indices and 3 neighbor indices (uint32),
+//   where the vertex index 0 is the infinite vertex and the index i + 1 is the finite vertex i
+// - the candidate points as pairs of doubles (x, y)
+// - the score of every candidate point as a double
+// - the site id of every finite vertex (uint32), at the end so the doubles stay 8 byte aligned
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint64_t inputHash;
+    std::uint32_t pointSize;
+    std::int32_t dimension;
+    std::uint64_t numberOfVertices;
+    std::uint64_t numberOfFaces;
+    std::uint64_t numberOfCandidates;
+    double circle[3];
+    double bbox[4];
+    std::uint64_t payloadChecksum;
+};
+static_assert(sizeof(SnapshotHeader) == 120, "the snapshot header must not have padding");
+
+// FNV-1a constants
+const std::uint64_t kFnvOffset = 14695981039346656037ull;
+const std::uint64_t kFnvPrime = 1099511628211ull;
+
+// function that continues a FNV-1a hash with a block of bytes
+std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// hash for the handles of the triangulation, using the address of the element
+struct HandleHash {
+    template <class Handle>
+    std::size_t operator()(const Handle& h) const { return std::hash<const void*>()(&*h); }
+};
+
+// writer that keeps the checksum of everything written to the payload
+struct PayloadWriter {
+    std::ofstream& out;
+    std::uint64_t checksum = kFnvOffset;
+
+    explicit PayloadWriter(std::ofstream& o):out(o){}
+
+    void write(const void* data, std::size_t size) {
+        out.write(static_cast<const char*>(data), size);
+        checksum = fnv1a(checksum, data, size);
+    }
+};
+
+}
+
+// function that returns a 64 bit content hash (FNV-1a) of the input points, used as the key of the snapshots
+std::uint64_t hashInputPoints(const std::vector<Point_2>& points) {
+    std::uint64_t hash = kFnvOffset;
+    std::uint64_t count = points.size();
+    hash = fnv1a(hash, &count, sizeof(count));
+    // the bit patterns of the coordinates are hashed, so any change in the input changes the key
+    for (const Point_2& point : points) {
+        double xy[2] = {CGAL::to_double(point.x()), CGAL::to_double(point.y())};
+        hash = fnv1a(hash, xy, sizeof(xy));
+    }
+    return hash;
+}
+
+// function that returns the route of the snapshot file for a content hash inside a directory
+std::string getSnapshotFilename(const std::string& directory, std::uint64_t inputHash) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "lec-%016llx.snap", static_cast<unsigned long long>(inputHash));
+    return directory + "/" + name;
+}
+
+// function that writes the triangulation and the candidate/score tables of the stages to a binary snapshot,
+// returns false if the snapshot could not be written
+bool writeSnapshot(const std::string& filename, std::uint64_t inputHash, const LargestEmptyCircleStages& stages) {
+    const Delaunay_triangulation_2& dt2 = stages.dt2;
+    // only full dimensional triangulations are stored, the degenerate ones are cheap to rebuild
+    if (dt2.dimension() != 2) return false;
+
+    // the finite vertices are numbered from 1, the infinite vertex is the 0
+    std::unordered_map<Vertex_handle, std::uint32_t, HandleHash> vertexIndex;
+    vertexIndex[dt2.infinite_vertex()] = 0;
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) {
+        std::uint32_t index = static_cast<std::uint32_t>(vertexIndex.size());
+        vertexIndex[v] = index;
+    }
+    // all the faces are numbered from 0
+    std::unordered_map<Face_handle, std::uint32_t, HandleHash> faceIndex;
+    for (auto f = dt2.all_faces_begin(); f != dt2.all_faces_end(); ++f) {
+        std::uint32_t index = static_cast<std::uint32_t>(faceIndex.size());
+        faceIndex[f] = index;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.endianTag = kEndianTag;
+    header.inputHash = inputHash;
+    header.pointSize = sizeof(double) * 2;
+    header.dimension = dt2.dimension();
+    header.numberOfVertices = vertexIndex.size() - 1;
+    header.numberOfFaces = faceIndex.size();
+    header.numberOfCandidates = stages.candidatePoints.size();
+    header.circle[0] = CGAL::to_double(stages.circle.center.x());
+    header.circle[1] = CGAL::to_double(stages.circle.center.y());
+    header.circle[2] = CGAL::to_double(stages.circle.squaredRadius);
+    header.bbox[0] = CGAL::to_double(stages.bbox.xmin());
+    header.bbox[1] = CGAL::to_double(stages.bbox.ymin());
+    header.bbox[2] = CGAL::to_double(stages.bbox.xmax());
+    header.bbox[3] = CGAL::to_double(stages.bbox.ymax());
+    header.payloadChecksum = 0;
+
+    // the snapshot is written to a temporary file and renamed at the end, so a reader never maps a half written file
+    std::string temporaryFilename = filename + ".tmp";
+    std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    // the header is written twice, the second time with the checksum of the payload
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    PayloadWriter payload(file);
+    // the finite vertices
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) {
+        double xy[2] = {CGAL::to_double(v->point().x()), CGAL::to_double(v->point().y())};
+        payload.write(xy, sizeof(xy));
+    }
+    // the faces
+    for (auto f = dt2.all_faces_begin(); f != dt2.all_faces_end(); ++f) {
+        std::uint32_t record[6];
+        for (int i = 0; i < 3; i++) {
+            record[i] = vertexIndex.at(f->vertex(i));
+            record[3 + i] = faceIndex.at(f->neighbor(i));
+        }
+        payload.write(record, sizeof(record));
+    }
+    // the candidate points and their scores
+    for (const Point_2& point : stages.candidatePoints) {
+        double xy[2] = {CGAL::to_double(point.x()), CGAL::to_double(point.y())};
+        payload.write(xy, sizeof(xy));
+    }
+    for (const K::FT& score : stages.candidateScores) {
+        double value = CGAL::to_double(score);
+        payload.write(&value, sizeof(value));
+    }
+    // the site ids of the finite vertices
+    for (auto v = dt2.finite_vertices_begin(); v != dt2.finite_vertices_end(); ++v) {
+        std::uint32_t id = v->info();
+        payload.write(&id, sizeof(id));
+    }
+
+    header.payloadChecksum = payload.checksum;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file) {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+    return std::rename(temporaryFilename.c_str(), filename.c_str()) == 0;
+}
+
+// function that maps a binary snapshot and rebuilds the triangulation and the candidate/score tables of the stages
+// without inserting any point, returns false (leaving the stages untouched) if the snapshot is missing, has another
+// version or hash, or is corrupted
+bool readSnapshot(const std::string& filename, std::uint64_t inputHash, LargestEmptyCircleStages& stages) {
+    MappedFile mapping(filename);
+    if (!mapping.isOpen()) return false;
+
+    // the header is checked before anything else is read
+    if (mapping.size() < sizeof(SnapshotHeader)) {
+        std::cerr << "Rejected snapshot " << filename << ": file too small" << std::endl;
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+        std::cerr << "Rejected snapshot " << filename << ": not a snapshot file" << std::endl;
+        return false;
+    }
+    // the byte order is checked first, with another one the other fields can't be read
+    if (header.endianTag != kEndianTag) {
+        std::cerr << "Rejected snapshot " << filename << ": it was written with another byte order" << std::endl;
+        return false;
+    }
+    if (header.version != kSnapshotVersion) {
+        std::cerr << "Rejected snapshot " << filename << ": version " << header.version << " but version " << kSnapshotVersion << " was expected" << std::endl;
+        return false;
+    }
+    if (header.pointSize != sizeof(double) * 2) {
+        std::cerr << "Rejected snapshot " << filename << ": points of " << header.pointSize << " bytes but points of " << sizeof(double) * 2 << " bytes were expected" << std::endl;
+        return false;
+    }
+    if (header.inputHash != inputHash) {
+        std::cerr << "Rejected snapshot " << filename << ": it was built from other input points" << std::endl;
+        return false;
+    }
+
+    // a 2 dimensional triangulation of n finite vertices (n + 1 with the infinite one) has 2n - 2 faces
+    std::uint64_t nv = header.numberOfVertices;
+    std::uint64_t nf = header.numberOfFaces;
+    std::uint64_t nc = header.numberOfCandidates;
+    if (header.dimension != 2 || nv < 3 || nv >= 0x7fffffffull || nf != 2 * nv - 2 || nc > mapping.size()) {
+        std::cerr << "Rejected snapshot " << filename << ": inconsistent sizes" << std::endl;
+        return false;
+    }
+    std::uint64_t payloadSize = nv * 2 * sizeof(double) + nf * 6 * sizeof(std::uint32_t) + nc * 3 * sizeof(double) + nv * sizeof(std::uint32_t);
+    if (mapping.size() != sizeof(SnapshotHeader) + payloadSize) {
+        std::cerr << "Rejected snapshot " << filename << ": truncated file" << std::endl;
+        return false;
+    }
+    const char* payload = mapping.data() + sizeof(SnapshotHeader);
+    if (fnv1a(kFnvOffset, payload, payloadSize) != header.payloadChecksum) {
+        std::cerr << "Rejected snapshot " << filename << ": checksum mismatch" << std::endl;
+        return false;
+    }
+
+    // the payload is 8 byte aligned because the mapping is page aligned and the header has 120 bytes
+    const double* vertices = reinterpret_cast<const double*>(payload);
+    const std::uint32_t* faces = reinterpret_cast<const std::uint32_t*>(payload + nv * 2 * sizeof(double));
+    const double* candidates = reinterpret_cast<const double*>(payload + nv * 2 * sizeof(double) + nf * 6 * sizeof(std::uint32_t));
+    const double* scores = candidates + nc * 2;
+    const std::uint32_t* siteIds = reinterpret_cast<const std::uint32_t*>(scores + nc);
+
+    // the indices and the adjacency of the faces are validated before the triangulation is touched
+    std::vector<bool> referenced(nv + 1, false);
+    for (std::uint64_t f = 0; f < nf; f++) {
+        const std::uint32_t* record = faces + f * 6;
+        for (int i = 0; i < 3; i++) {
+            if (record[i] > nv || record[3 + i] >= nf) {
+                std::cerr << "Rejected snapshot " << filename << ": index out of range" << std::endl;
+                return false;
+            }
+            referenced[record[i]] = true;
+            // the neighbor must point back to this face
+            const std::uint32_t* neighbor = faces + std::uint64_t(record[3 + i]) * 6;
+            if (neighbor[3] != f && neighbor[4] != f && neighbor[5] != f) {
+                std::cerr << "Rejected snapshot " << filename << ": broken adjacency" << std::endl;
+                return false;
+            }
+        }
+    }
+    for (bool isReferenced : referenced) {
+        if (!isReferenced) {
+            std::cerr << "Rejected snapshot " << filename << ": vertex without faces" << std::endl;
+            return false;
+        }
+    }
+
+    // the triangulation data structure is rebuilt directly, no point is inserted
+    Delaunay_triangulation_2& dt2 = stages.dt2;
+    dt2.clear();
+    auto& tds = dt2.tds();
+    tds.clear();
+    std::vector<Vertex_handle> vertexHandles(nv + 1);
+    vertexHandles[0] = tds.create_vertex();
+    dt2.set_infinite_vertex(vertexHandles[0]);
+    for (std::uint64_t i = 0; i < nv; i++) {
+        vertexHandles[i + 1] = tds.create_vertex();
+        vertexHandles[i + 1]->set_point(Point_2(vertices[2 * i], vertices[2 * i + 1]));
+        vertexHandles[i + 1]->info() = siteIds[i];
+    }
+    std::vector<Face_handle> faceHandles(nf);
+    for (std::uint64_t f = 0; f < nf; f++) {
+        const std::uint32_t* record = faces + f * 6;
+        faceHandles[f] = tds.create_face(vertexHandles[record[0]], vertexHandles[record[1]], vertexHandles[record[2]]);
+    }
+    for (std::uint64_t f = 0; f < nf; f++) {
+        const std::uint32_t* record = faces + f * 6;
+        faceHandles[f]->set_neighbors(faceHandles[record[3]], faceHandles[record[4]], faceHandles[record[5]]);
+        for (int i = 0; i < 3; i++) {
+            vertexHandles[record[i]]->set_face(faceHandles[f]);
+        }
+    }
+    tds.set_dimension(2);
+
+    // the candidate and score tables and the derived values are restored
+    stages.bbox = Iso_rectangle_2(header.bbox[0], header.bbox[1], header.bbox[2], header.bbox[3]);
+    stages.voronoiSegments.clear();
+    stages.ch.clear();
+    stages.chSegments.clear();
+    stages.candidatePoints.resize(nc);
+    stages.candidateScores.resize(nc);
+    for (std::uint64_t i = 0; i < nc; i++) {
+        stages.candidatePoints[i] = Point_2(candidates[2 * i], candidates[2 * i + 1]);
+        stages.candidateScores[i] = scores[i];
+    }
+    stages.circle.center = Point_2(header.circle[0], header.circle[1]);
+    stages.circle.squaredRadius = header.circle[2];
+    stages.topCircles.assign(1, stages.circle);
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef TRIANGULATION_SNAPSHOT_H
+#define TRIANGULATION_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "largestEmptyCircle.h"
+
+// version of the snapshot binary format, it must be increased every time the layout changes
+// so old snapshots are rejected instead of being misread
+const std::uint32_t kSnapshotVersion = 2;
+
+// function that returns a 64 bit content hash (FNV-1a) of the input points, used as the key of the snapshots
+std::uint64_t hashInputPoints(const std::vector<Point_2>& points);
+
+// function that returns the route of the snapshot file for a content hash inside a directory
+std::string getSnapshotFilename(const std::string& directory, std::uint64_t inputHash);
+
+// function that writes the triangulation and the candidate/score tables of the stages to a binary snapshot,
+// returns false if the snapshot could not be written
+bool writeSnapshot(const std::string& filename, std::uint64_t inputHash, const LargestEmptyCircleStages& stages);
+
+// function that maps a binary snapshot and rebuilds the triangulation and the candidate/score tables of the stages
+// without inserting any point, returns false (leaving the stages untouched) if the snapshot is missing, has another
+// version or hash, or is corrupted
+bool readSnapshot(const std::string& filename, std::uint64_t inputHash, LargestEmptyCircleStages& stages);
+
+#endif